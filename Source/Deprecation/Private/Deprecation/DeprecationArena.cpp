@@ -0,0 +1,117 @@
+#include "Deprecation/DeprecationArena.h"
+
+#include "Templates/Atomic.h"
+
+//------------------------
+namespace
+{
+	thread_local FDeprecationArena* CurrentArena = nullptr;
+
+	/** Size in bytes of the first chunk of an arena, enough for the tree of a small object. */
+	constexpr SIZE_T FirstChunkSize = 1024;
+
+	/** Size in bytes chunks stop growing at, the size of a page of the engine stack allocators. */
+	constexpr SIZE_T MaxChunkSize = 64 * 1024;
+
+	TAtomic<uint64> TotalAllocatedSize { 0 };
+	TAtomic<uint64> TotalNumAllocations { 0 };
+}
+
+//------------------------
+FDeprecationArena::FScope::FScope(FDeprecationArena& Arena)
+	: PreviousArena(CurrentArena)
+{
+	CurrentArena = &Arena;
+}
+
+//------------------------
+FDeprecationArena::FScope::~FScope()
+{
+	CurrentArena = PreviousArena;
+}
+
+//------------------------
+FDeprecationArena::FDeprecationArena()
+	: Chunks(nullptr)
+	, Top(nullptr)
+	, End(nullptr)
+	, Destructors(nullptr)
+	, AllocatedSize(0)
+	, NumAllocations(0)
+{
+}
+
+//------------------------
+FDeprecationArena::~FDeprecationArena()
+{
+	Reset();
+}
+
+//------------------------
+void FDeprecationArena::Reset()
+{
+	check(CurrentArena != this);
+
+	for (FDestructor* Destructor = Destructors; Destructor; Destructor = Destructor->Next)
+	{
+		Destructor->Destruct(Destructor->Object);
+	}
+	Destructors = nullptr;
+
+	if (NumAllocations > 0)
+	{
+		TotalAllocatedSize += (uint64)GetAllocatedSize();
+		TotalNumAllocations += (uint64)NumAllocations;
+		AllocatedSize = 0;
+		NumAllocations = 0;
+	}
+
+	while (Chunks)
+	{
+		FChunk* Next = Chunks->Next;
+		FMemory::Free(Chunks);
+		Chunks = Next;
+	}
+
+	Top = nullptr;
+	End = nullptr;
+}
+
+//------------------------
+void* FDeprecationArena::AllocFromNewChunk(SIZE_T Size, SIZE_T Alignment)
+{
+	Alignment = FMath::Max<SIZE_T>(Alignment, 1);
+
+	// Large allocations get a chunk of their own size, the remainder of the current chunk is left unused.
+	const SIZE_T GrownSize = Chunks ? FMath::Min(Chunks->Size * 2, MaxChunkSize) : FirstChunkSize;
+	const SIZE_T ChunkSize = FMath::Max(GrownSize, sizeof(FChunk) + Size + Alignment);
+
+	FChunk* Chunk = (FChunk*)FMemory::Malloc(ChunkSize);
+	Chunk->Next = Chunks;
+	Chunk->Size = ChunkSize;
+	Chunks = Chunk;
+
+	const UPTRINT Result = Align((UPTRINT)(Chunk + 1), Alignment);
+	Top = (uint8*)(Result + Size);
+	End = (uint8*)Chunk + ChunkSize;
+
+	return (void*)Result;
+}
+
+//------------------------
+FDeprecationArena* FDeprecationArena::GetCurrent()
+{
+	return CurrentArena;
+}
+
+//------------------------
+uint64 FDeprecationArena::GetTotalAllocatedSize()
+{
+	return TotalAllocatedSize.Load();
+}
+
+//------------------------
+uint64 FDeprecationArena::GetTotalNumAllocations()
+{
+	return TotalNumAllocations.Load();
+}
@@ -0,0 +1,401 @@
+#include "Deprecation/DeprecationClassCache.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/ScopeRWLock.h"
+#include "Misc/SecureHash.h"
+#include "Modules/ModuleManager.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+#include "UObject/UObjectIterator.h"
+#include "UObject/UnrealType.h"
+
+//------------------------
+namespace
+{
+	//------------------------
+	FGuid MakeCustomVersionKey(const UClass* Class, FName VersionPropertyName)
+	{
+		// Hashing UTF-8 so the key is the same whatever the size of TCHAR on the platform.
+		const FString KeyString = Class->GetPathName() + TEXT(":") + VersionPropertyName.ToString();
+		FTCHARToUTF8 KeyUtf8(*KeyString);
+
+		uint8 Hash[FSHA1::DigestSize];
+		FSHA1::HashBuffer(KeyUtf8.Get(), KeyUtf8.Length(), Hash);
+
+		FGuid Key;
+		FMemory::Memcpy(&Key, Hash, sizeof(FGuid));
+		return Key;
+	}
+
+	//------------------------
+	FName MakeCustomVersionFriendlyName(const UClass* Class)
+	{
+		return FName(*FString::Printf(TEXT("Deprecation_%s"), *Class->GetName()));
+	}
+
+#if !UE_BUILD_SHIPPING
+	FAutoConsoleCommandWithOutputDevice DumpCountersCommand(
+		TEXT("Deprecation.DumpCounters"),
+		TEXT("Writes the deprecation counters of every class loaded so far."),
+		FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+		{
+			FDeprecationClassCache::Get().DumpCounters(Ar);
+		}));
+
+	FAutoConsoleCommand ResetCountersCommand(
+		TEXT("Deprecation.ResetCounters"),
+		TEXT("Resets the deprecation counters of every class."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FDeprecationClassCache::Get().ResetCounters();
+		}));
+#endif // !UE_BUILD_SHIPPING
+}
+
+//------------------------
+FDeprecationClassCache& FDeprecationClassCache::Get()
+{
+	static FDeprecationClassCache Instance;
+	return Instance;
+}
+
+//------------------------
+FName FDeprecationClassCache::GetDefaultVersionPropertyName()
+{
+	static const FName DefaultVersionPropertyName(TEXT("DeprecationVersion"));
+	return DefaultVersionPropertyName;
+}
+
+//------------------------
+void FDeprecationClassCache::Initialize()
+{
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddRaw(this, &FDeprecationClassCache::PurgeStaleInfos);
+
+	// Custom versions are registered before any package using them is loaded: the classes loaded so far,
+	// then the ones of each module loaded afterwards, then all of them once every module is loaded.
+	RegisterCustomVersions(NAME_None);
+
+	ModulesChangedHandle = FModuleManager::Get().OnModulesChanged().AddLambda([this](FName ModuleName, EModuleChangeReason Reason)
+	{
+		if (Reason == EModuleChangeReason::ModuleLoaded)
+		{
+			RegisterCustomVersions(*(TEXT("/Script/") + ModuleName.ToString()));
+		}
+	});
+
+	PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddLambda([this]()
+	{
+		RegisterCustomVersions(NAME_None);
+	});
+
+#if WITH_HOT_RELOAD
+	HotReloadHandle = FCoreUObjectDelegates::RegisterHotReloadAddedClassesDelegate.AddLambda([this](const TArray<UClass*>&)
+	{
+		InvalidateAll();
+	});
+
+	// Reinstanced classes keep their path but get new properties and a new default object.
+	ReinstanceHandle = FCoreUObjectDelegates::RegisterClassForHotReloadReinstancingDelegate.AddLambda([this](UClass* OldClass, UClass* NewClass, EHotReloadedClassFlags)
+	{
+		Invalidate(OldClass);
+
+		if (NewClass)
+		{
+			Invalidate(NewClass);
+			RegisterCustomVersions(NewClass);
+		}
+	});
+
+	ReloadCompleteHandle = FCoreUObjectDelegates::ReinstanceHotReloadedClassesDelegate.AddLambda([this]()
+	{
+		InvalidateAll();
+	});
+#endif // WITH_HOT_RELOAD
+}
+
+//------------------------
+void FDeprecationClassCache::Shutdown()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	FModuleManager::Get().OnModulesChanged().Remove(ModulesChangedHandle);
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+
+#if WITH_HOT_RELOAD
+	FCoreUObjectDelegates::RegisterHotReloadAddedClassesDelegate.Remove(HotReloadHandle);
+	FCoreUObjectDelegates::RegisterClassForHotReloadReinstancingDelegate.Remove(ReinstanceHandle);
+	FCoreUObjectDelegates::ReinstanceHotReloadedClassesDelegate.Remove(ReloadCompleteHandle);
+#endif // WITH_HOT_RELOAD
+
+	InvalidateAll();
+
+	FWriteScopeLock WriteLock(Lock);
+	CustomVersions.Empty();
+}
+
+//------------------------
+FDeprecationClassInfoPtr FDeprecationClassCache::FindOrAdd(UClass* Class, FName VersionPropertyName)
+{
+	check(Class);
+	const FKey Key(Class, VersionPropertyName);
+
+	{
+		FReadScopeLock ReadLock(Lock);
+
+		const FDeprecationClassInfoPtr* Info = Infos.Find(Key);
+		if (Info && (*Info)->IsValidFor(Class))
+		{
+			return *Info;
+		}
+	}
+
+	FDeprecationClassInfoPtr Info = MakeInfo(Class, VersionPropertyName);
+
+	FWriteScopeLock WriteLock(Lock);
+
+	// Another thread may have populated the same class in the meantime, the first one wins.
+	FDeprecationClassInfoPtr& CachedInfo = Infos.FindOrAdd(Key);
+	if (!CachedInfo.IsValid() || !CachedInfo->IsValidFor(Class))
+	{
+		CachedInfo = Info;
+
+		// Classes loaded from packages (e.g. blueprints) may not have been around for the eager registration.
+		if (Info->VersionProperty)
+		{
+			RegisterCustomVersion(Info->CustomVersionKey, Info->CustomVersionFriendlyName);
+		}
+	}
+
+	return CachedInfo;
+}
+
+//------------------------
+void FDeprecationClassCache::Invalidate(const UClass* Class)
+{
+	FWriteScopeLock WriteLock(Lock);
+
+	for (auto It = Infos.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Key == Class)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+//------------------------
+void FDeprecationClassCache::InvalidateAll()
+{
+	FWriteScopeLock WriteLock(Lock);
+	Infos.Empty();
+}
+
+//------------------------
+void FDeprecationClassCache::DumpCounters(FOutputDevice& Ar)
+{
+	FReadScopeLock ReadLock(Lock);
+
+	Ar.Logf(TEXT("%-48s %10s %10s %10s %12s %14s %12s %10s"), TEXT("Class"), TEXT("Upgraded"), TEXT("Skipped"), TEXT("Refused"), TEXT("Properties"), TEXT("Bytes"), TEXT("NestedMaps"), TEXT("CacheHits"));
+
+	for (const TPair<FKey, FDeprecationClassInfoPtr>& Pair : Infos)
+	{
+		const FDeprecationClassInfo& Info = *Pair.Value;
+		const UClass* Class = Info.Class.Get();
+		if (!Class)
+		{
+			continue;
+		}
+
+		Ar.Logf(TEXT("%-48s %10llu %10llu %10llu %12llu %14llu %12llu %10llu"), *Class->GetName(),
+			Info.Counters.NumUpgraded.Load(), Info.Counters.NumSkipped.Load(), Info.Counters.NumRefused.Load(), Info.Counters.NumPropertiesDecoded.Load(),
+			Info.Counters.NumBytesDecoded.Load(), Info.Counters.NumNestedMaps.Load(), Info.Counters.NumCacheHits.Load());
+	}
+}
+
+//------------------------
+void FDeprecationClassCache::ResetCounters()
+{
+	FReadScopeLock ReadLock(Lock);
+
+	for (const TPair<FKey, FDeprecationClassInfoPtr>& Pair : Infos)
+	{
+		FDeprecationClassCounters& Counters = Pair.Value->Counters;
+		Counters.NumUpgraded = 0;
+		Counters.NumSkipped = 0;
+		Counters.NumRefused = 0;
+		Counters.NumPropertiesDecoded = 0;
+		Counters.NumBytesDecoded = 0;
+		Counters.NumNestedMaps = 0;
+		Counters.NumCacheHits = 0;
+	}
+}
+
+//------------------------
+FDeprecationClassInfoPtr FDeprecationClassCache::MakeInfo(UClass* Class, FName VersionPropertyName) const
+{
+	TSharedRef<FDeprecationClassInfo, ESPMode::ThreadSafe> Info = MakeShared<FDeprecationClassInfo, ESPMode::ThreadSafe>();
+	Info->Class = Class;
+	Info->ClassDefaultObject = Class->GetDefaultObject();
+	Info->VersionPropertyName = VersionPropertyName;
+
+	Info->VersionProperty = CastField<FUInt64Property>(Class->FindPropertyByName(VersionPropertyName));
+	if (!ensureAlwaysMsgf(Info->VersionProperty, TEXT("Version property with name '%s' not found."), *VersionPropertyName.ToString()))
+	{
+		return Info;
+	}
+
+	const uint64 CodeVersion = *Info->VersionProperty->ContainerPtrToValuePtr<uint64>(Info->ClassDefaultObject);
+
+	// Saved packages record the version as a custom version, which is 32 bits. The scopes of the class are disabled otherwise.
+	if (!ensureAlwaysMsgf(CodeVersion <= (uint64)MAX_int32, TEXT("Version property with name '%s' of class '%s' is %llu, it can not be greater than MAX_int32."),
+		*VersionPropertyName.ToString(), *Class->GetName(), CodeVersion))
+	{
+		Info->VersionProperty = nullptr;
+		return Info;
+	}
+
+	Info->CodeVersion = CodeVersion;
+	Info->CustomVersionKey = MakeCustomVersionKey(Class, VersionPropertyName);
+	Info->CustomVersionFriendlyName = MakeCustomVersionFriendlyName(Class);
+
+	Info->FieldRules = FDeprecationRegistry::Get().BuildFieldRules(Class, VersionPropertyName);
+	if (Info->FieldRules.IsValid())
+	{
+		ResolveFieldRuleTargets(*Info);
+	}
+
+	Info->Steps = FDeprecationRegistry::Get().BuildSteps(Class, VersionPropertyName);
+	if (Info->Steps.IsValid())
+	{
+		Info->bHasValidSteps = Info->Steps->Validate(Class, Info->CodeVersion);
+	}
+
+	return Info;
+}
+
+//------------------------
+void FDeprecationClassCache::ResolveFieldRuleTargets(FDeprecationClassInfo& Info)
+{
+	UClass* Class = Info.Class.Get();
+
+	for (const FDeprecationFieldRules::FRule& Rule : Info.FieldRules->GetRules())
+	{
+		if (!ensureAlwaysMsgf(Rule.Version <= Info.CodeVersion, TEXT("Field rule '%s' -> '%s' of class '%s' has version %llu, the code is only at version %llu."),
+			*Rule.OldPath.ToString(), *Rule.NewPath.ToString(), *Class->GetName(), Rule.Version, Info.CodeVersion))
+		{
+			Info.bHasValidFieldRules = false;
+		}
+
+		if (Info.FieldRuleTargets.Contains(Rule.NewPath))
+		{
+			continue;
+		}
+
+		TArray<FString> PropertyNames;
+		Rule.NewPath.ToString().ParseIntoArray(PropertyNames, TEXT("."));
+
+		TArray<FProperty*, TInlineAllocator<2>> Target;
+		const UStruct* Struct = Class;
+
+		for (const FString& PropertyName : PropertyNames)
+		{
+			FProperty* Property = Struct ? Struct->FindPropertyByName(*PropertyName) : nullptr;
+			if (!Property)
+			{
+				Target.Reset();
+				break;
+			}
+
+			Target.Add(Property);
+
+			// Only the last property of the path can be something else than a structure.
+			const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+			Struct = StructProperty ? StructProperty->Struct : nullptr;
+		}
+
+		if (!ensureAlwaysMsgf(Target.Num() > 0, TEXT("Field rule '%s' -> '%s' of class '%s' targets a property that does not exist."),
+			*Rule.OldPath.ToString(), *Rule.NewPath.ToString(), *Class->GetName()))
+		{
+			Info.bHasValidFieldRules = false;
+			continue;
+		}
+
+		Info.FieldRuleTargets.Add(Rule.NewPath, MoveTemp(Target));
+	}
+}
+
+//------------------------
+void FDeprecationClassCache::PurgeStaleInfos()
+{
+	FWriteScopeLock WriteLock(Lock);
+
+	for (auto It = Infos.CreateIterator(); It; ++It)
+	{
+		if (!It.Value()->Class.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+//------------------------
+void FDeprecationClassCache::RegisterCustomVersions(FName PackageName)
+{
+	TArray<FName> VersionPropertyNames;
+	VersionPropertyNames.Add(GetDefaultVersionPropertyName());
+	FDeprecationRegistry::Get().GetVersionPropertyNames(VersionPropertyNames);
+
+	TArray<TPair<FGuid, FName>> Registrations;
+
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		const UClass* Class = *It;
+		if (Class->HasAnyClassFlags(CLASS_NewerVersionExists) || (!PackageName.IsNone() && Class->GetOutermost()->GetFName() != PackageName))
+		{
+			continue;
+		}
+
+		for (const FName& VersionPropertyName : VersionPropertyNames)
+		{
+			if (CastField<FUInt64Property>(Class->FindPropertyByName(VersionPropertyName)))
+			{
+				Registrations.Emplace(MakeCustomVersionKey(Class, VersionPropertyName), MakeCustomVersionFriendlyName(Class));
+			}
+		}
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+
+	for (const TPair<FGuid, FName>& Registration : Registrations)
+	{
+		RegisterCustomVersion(Registration.Key, Registration.Value);
+	}
+}
+
+//------------------------
+void FDeprecationClassCache::RegisterCustomVersions(const UClass* Class)
+{
+	TArray<FName> VersionPropertyNames;
+	VersionPropertyNames.Add(GetDefaultVersionPropertyName());
+	FDeprecationRegistry::Get().GetVersionPropertyNames(VersionPropertyNames);
+
+	FWriteScopeLock WriteLock(Lock);
+
+	for (const FName& VersionPropertyName : VersionPropertyNames)
+	{
+		if (CastField<FUInt64Property>(Class->FindPropertyByName(VersionPropertyName)))
+		{
+			RegisterCustomVersion(MakeCustomVersionKey(Class, VersionPropertyName), MakeCustomVersionFriendlyName(Class));
+		}
+	}
+}
+
+//------------------------
+void FDeprecationClassCache::RegisterCustomVersion(const FGuid& Key, FName FriendlyName)
+{
+	// The registered version never changes with the code, see RegisterCustomVersion in the header.
+	if (!CustomVersions.Contains(Key))
+	{
+		CustomVersions.Add(Key, MakeUnique<FCustomVersionRegistration>(Key, MAX_int32, FriendlyName));
+	}
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/CustomVersion.h"
+#include "Templates/Atomic.h"
+#include "UObject/WeakObjectPtr.h"
+
+#include "Deprecation/DeprecationRegistry.h"
+
+/**
+ * Counters of the deprecation work done for a class, cheap enough to always be updated.
+ */
+struct FDeprecationClassCounters
+{
+	TAtomic<uint64> NumUpgraded { 0 };
+	TAtomic<uint64> NumSkipped { 0 };
+	TAtomic<uint64> NumRefused { 0 };
+	TAtomic<uint64> NumPropertiesDecoded { 0 };
+	TAtomic<uint64> NumBytesDecoded { 0 };
+	TAtomic<uint64> NumNestedMaps { 0 };
+	TAtomic<uint64> NumCacheHits { 0 };
+};
+
+/**
+ * Deprecation data of a class, shared by the scopes of all its objects.
+ */
+struct FDeprecationClassInfo
+{
+	/**
+	 * Checks if the info still describes the given class.
+	 * A regenerated class gets a new default object, which makes its previous info stale.
+	 * @param InClass Class to check.
+	 * @returns True if the info can be used for the class, false otherwise.
+	 */
+	inline bool IsValidFor(const UClass* InClass) const
+	{
+		return Class.Get() == InClass
+			&& InClass->GetDefaultObject(false) == ClassDefaultObject;
+	}
+
+	TWeakObjectPtr<UClass> Class;
+	const UObject* ClassDefaultObject = nullptr;
+
+	FUInt64Property* VersionProperty = nullptr;
+	FName VersionPropertyName;
+	uint64 CodeVersion = 0;
+
+	/** Key of the custom version recording the deprecation version of the class in package summaries. */
+	FGuid CustomVersionKey;
+	FName CustomVersionFriendlyName;
+
+	/** Declarative rules of the class and its super classes, null if none. */
+	FDeprecationFieldRulesPtr FieldRules;
+
+	/** Properties leading to the target of each new path of the rules, from the class to the target itself. */
+	TMap<FName, TArray<FProperty*, TInlineAllocator<2>>> FieldRuleTargets;
+
+	/** Whether or not every rule targets an existing property, at a version the code has reached. */
+	bool bHasValidFieldRules = true;
+
+	/** Chain of step handlers of the class and its super classes, null if none. */
+	FDeprecationStepsPtr Steps;
+
+	/** Whether or not the chain has one step per version, within the versions of the code. */
+	bool bHasValidSteps = true;
+
+	/** Updated by scopes, while the rest of the info is immutable once cached. */
+	mutable FDeprecationClassCounters Counters;
+};
+
+typedef TSharedPtr<const FDeprecationClassInfo, ESPMode::ThreadSafe> FDeprecationClassInfoPtr;
+
+/**
+ * Thread-safe cache of the deprecation data of every class using a deprecation scope.
+ * Populated the first time an object of a class is serialized, invalidated on hot reload (added, reinstanced and reloaded classes)
+ * and garbage collection.
+ */
+class FDeprecationClassCache final
+{
+	// Typedefs
+private:
+	typedef TPair<const UClass*, FName> FKey;
+
+
+
+
+	// Constructors
+private:
+	FDeprecationClassCache() = default;
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Returns the instance of the cache.
+	 */
+	static FDeprecationClassCache& Get();
+
+	/**
+	 * Returns the name of the version property used when scopes do not give one.
+	 */
+	static FName GetDefaultVersionPropertyName();
+
+	/**
+	 * Registers the custom versions of the classes loaded so far, then the callbacks registering the next ones
+	 * and invalidating the cache.
+	 */
+	void Initialize();
+
+	/**
+	 * Unregisters the callbacks and empties the cache.
+	 */
+	void Shutdown();
+
+	/**
+	 * Retrieves the deprecation data of a class, looking it up on first request.
+	 * @param Class Class of the object being serialized.
+	 * @param VersionPropertyName Name of the property holding the deprecation version.
+	 * @returns Shared deprecation data of the class.
+	 */
+	FDeprecationClassInfoPtr FindOrAdd(UClass* Class, FName VersionPropertyName);
+
+	/**
+	 * Removes the deprecation data of a class, it will be looked up again on next request.
+	 * @param Class Class to invalidate.
+	 */
+	void Invalidate(const UClass* Class);
+
+	/**
+	 * Removes the deprecation data of all the classes.
+	 */
+	void InvalidateAll();
+
+	/**
+	 * Writes the counters of every cached class.
+	 * @param Ar Output device to write to.
+	 */
+	void DumpCounters(FOutputDevice& Ar);
+
+	/**
+	 * Resets the counters of every cached class.
+	 */
+	void ResetCounters();
+
+private:
+	/**
+	 * Looks up the deprecation data of a class through reflection.
+	 * @param Class Class to look up.
+	 * @param VersionPropertyName Name of the property holding the deprecation version.
+	 * @returns Newly created deprecation data.
+	 */
+	FDeprecationClassInfoPtr MakeInfo(UClass* Class, FName VersionPropertyName) const;
+
+	/**
+	 * Resolves the properties targeted by the field rules of a class.
+	 * @param Info Deprecation data of the class, with its rules.
+	 */
+	static void ResolveFieldRuleTargets(FDeprecationClassInfo& Info);
+
+	/**
+	 * Removes the data of the classes that have been garbage collected.
+	 */
+	void PurgeStaleInfos();
+
+	/**
+	 * Registers the custom versions of the classes with a version property, default or named by a declaration.
+	 * @param PackageName Package of the classes to register (e.g. /Script/Module), all classes if none.
+	 */
+	void RegisterCustomVersions(FName PackageName);
+
+	/**
+	 * Registers the custom versions of a single class, e.g. once reinstanced.
+	 * @param Class Class to register.
+	 */
+	void RegisterCustomVersions(const UClass* Class);
+
+	/**
+	 * Registers a custom version, so packages recording it in their summary load without warnings.
+	 * It is registered at MAX_int32 whatever the version of the class: scopes write the version of each class explicitly
+	 * in the packages they save, while the linker refuses packages recording a version greater than the registered one.
+	 * This way packages saved by a newer build still load, and are then skipped as newer than the code.
+	 * Must be called with the write lock held.
+	 * @param Key Key of the custom version.
+	 * @param FriendlyName Name of the custom version.
+	 */
+	void RegisterCustomVersion(const FGuid& Key, FName FriendlyName);
+
+
+
+
+	// Fields
+private:
+	FRWLock Lock;
+	TMap<FKey, FDeprecationClassInfoPtr> Infos;
+	TMap<FGuid, TUniquePtr<FCustomVersionRegistration>> CustomVersions;
+
+	FDelegateHandle PostGarbageCollectHandle;
+	FDelegateHandle ModulesChangedHandle;
+	FDelegateHandle PostEngineInitHandle;
+	FDelegateHandle HotReloadHandle;
+	FDelegateHandle ReinstanceHandle;
+	FDelegateHandle ReloadCompleteHandle;
+};
@@ -0,0 +1,76 @@
+#include "Deprecation/DeprecationFieldRules.h"
+
+#include "Deprecation/DeprecationRegistry.h"
+
+//------------------------
+FDeprecationFieldRules::FRegistrar::FRegistrar(ClassGetter GetClass, const TCHAR* VersionPropertyName, RegisterFunction Register)
+{
+	FDeprecationRegistry::Get().AddFieldRules(GetClass, VersionPropertyName, Register);
+}
+
+//------------------------
+FDeprecationFieldRules& FDeprecationFieldRules::Rename(uint64 Version, FName OldName, FName NewName)
+{
+	return AddRule(Version, OldName, NewName);
+}
+
+//------------------------
+FDeprecationFieldRules& FDeprecationFieldRules::Widen(uint64 Version, FName Name)
+{
+	// Same path, only the type changes: the value is converted when applied.
+	return AddRule(Version, Name, Name);
+}
+
+//------------------------
+FDeprecationFieldRules& FDeprecationFieldRules::MoveToStruct(uint64 Version, FName OldName, FName NewPath)
+{
+	return AddRule(Version, OldName, NewPath);
+}
+
+//------------------------
+FName FDeprecationFieldRules::MapPath(FName OldPath, uint64 AssetVersion, uint64 CodeVersion) const
+{
+	FName Path = OldPath;
+	bool bIsMapped = false;
+
+	for (const FRule& Rule : Rules)
+	{
+		if (Rule.Version <= AssetVersion)
+		{
+			continue;
+		}
+		if (Rule.Version > CodeVersion)
+		{
+			break;
+		}
+
+		// Each step starts from the path given by the previous ones.
+		if (Rule.OldPath == Path)
+		{
+			Path = Rule.NewPath;
+			bIsMapped = true;
+		}
+	}
+
+	return bIsMapped ? Path : NAME_None;
+}
+
+//------------------------
+void FDeprecationFieldRules::Sort()
+{
+	Rules.StableSort([](const FRule& A, const FRule& B)
+	{
+		return A.Version < B.Version;
+	});
+}
+
+//------------------------
+FDeprecationFieldRules& FDeprecationFieldRules::AddRule(uint64 Version, FName OldPath, FName NewPath)
+{
+	FRule& Rule = Rules.AddDefaulted_GetRef();
+	Rule.Version = Version;
+	Rule.OldPath = OldPath;
+	Rule.NewPath = NewPath;
+
+	return *this;
+}
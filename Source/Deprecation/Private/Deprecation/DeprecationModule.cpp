@@ -2,4 +2,24 @@
 
 #include "Deprecation/DeprecationModule.h"
 
+#include "Deprecation/DeprecationClassCache.h"
+#include "Deprecation/DeprecationPendingUpgrades.h"
+#include "Deprecation/DeprecationRegistry.h"
+
+//-------------------------------
+void FDeprecationModule::StartupModule()
+{
+	FDeprecationClassCache::Get().Initialize();
+	FDeprecationPendingUpgrades::Get().Initialize();
+	FDeprecationRegistry::Get().Initialize();
+}
+
+//-------------------------------
+void FDeprecationModule::ShutdownModule()
+{
+	FDeprecationRegistry::Get().Shutdown();
+	FDeprecationPendingUpgrades::Get().Shutdown();
+	FDeprecationClassCache::Get().Shutdown();
+}
+
 IMPLEMENT_MODULE(FDeprecationModule, Deprecation)
\ No newline at end of file
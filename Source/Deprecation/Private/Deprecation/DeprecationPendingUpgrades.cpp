@@ -0,0 +1,302 @@
+#include "Deprecation/DeprecationPendingUpgrades.h"
+
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/UObjectGlobals.h"
+
+static TAutoConsoleVariable<float> CVarPendingUpgradesBudgetMs(
+	TEXT("Deprecation.PendingUpgradesBudgetMs"),
+	0.0f,
+	TEXT("Time in milliseconds the ticker may spend running pending upgrades each frame, 0 for no limit.\n")
+	TEXT("Upgrades left over run on the next frames."));
+
+//------------------------
+FDeprecationPendingUpgrades& FDeprecationPendingUpgrades::Get()
+{
+	static FDeprecationPendingUpgrades Instance;
+	return Instance;
+}
+
+//------------------------
+void FDeprecationPendingUpgrades::Initialize()
+{
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FDeprecationPendingUpgrades::Tick));
+}
+
+//------------------------
+void FDeprecationPendingUpgrades::Shutdown()
+{
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	// Tasks still running would outlive the module.
+	WaitForDecoding();
+
+	FScopeLock ScopeLock(&Lock);
+	Upgrades.Empty();
+	Head = 0;
+	NumRunUpgrades = 0;
+}
+
+//------------------------
+void FDeprecationPendingUpgrades::Add(FDeprecationPendingUpgrade&& Upgrade)
+{
+	FScopeLock ScopeLock(&Lock);
+	Upgrades.Add(MakeShared<FDeprecationPendingUpgrade, ESPMode::ThreadSafe>(MoveTemp(Upgrade)));
+}
+
+//------------------------
+bool FDeprecationPendingUpgrades::Run(const UObject* Object)
+{
+	check(IsInGameThread());
+
+	bool bHasRun = false;
+
+	FDeprecationPendingUpgradePtr Upgrade;
+	for (int32 Index = Head; GetUpgrade(Index, Upgrade); ++Index)
+	{
+		if (!Upgrade.IsValid() || Upgrade->Object.Get() != Object)
+		{
+			continue;
+		}
+
+		// Once an upgrade has to wait, the next ones of the object wait as well, so they keep their order.
+		if (Upgrade->bIsRunning || !IsReady(*Upgrade, false))
+		{
+			break;
+		}
+
+		RunAt(Index, *Upgrade);
+		bHasRun = true;
+	}
+
+	Compact();
+	return bHasRun;
+}
+
+//------------------------
+bool FDeprecationPendingUpgrades::Contains(const UObject* Object)
+{
+	uint64 AssetVersion;
+	return FindAssetVersion(Object, AssetVersion);
+}
+
+//------------------------
+bool FDeprecationPendingUpgrades::FindAssetVersion(const UObject* Object, uint64& OutAssetVersion)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	// Running upgrades are still pending, their handler has not returned yet.
+	for (int32 Index = Head; Index < Upgrades.Num(); ++Index)
+	{
+		const FDeprecationPendingUpgradePtr& Upgrade = Upgrades[Index];
+		if (Upgrade.IsValid() && Upgrade->Object.Get() == Object)
+		{
+			OutAssetVersion = Upgrade->AssetVersion;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//------------------------
+int32 FDeprecationPendingUpgrades::RunReady(double MaxSeconds)
+{
+	check(IsInGameThread());
+
+	const double EndTime = FPlatformTime::Seconds() + MaxSeconds;
+
+	// Objects still being loaded are upgraded later (or by their PostLoad), their next upgrades wait as well to keep their order.
+	TSet<const UObject*> BlockedObjects;
+
+	int32 NumRun = 0;
+
+	FDeprecationPendingUpgradePtr Upgrade;
+	for (int32 Index = Head; GetUpgrade(Index, Upgrade); ++Index)
+	{
+		if (!Upgrade.IsValid())
+		{
+			continue;
+		}
+
+		const UObject* Object = Upgrade->Object.Get();
+		if (Object && BlockedObjects.Contains(Object))
+		{
+			continue;
+		}
+
+		if (Upgrade->bIsRunning || !IsReady(*Upgrade, true))
+		{
+			BlockedObjects.Add(Object);
+			continue;
+		}
+
+		RunAt(Index, *Upgrade);
+		++NumRun;
+
+		// Upgrades left over stay in place for the next frames.
+		if (MaxSeconds > 0.0 && FPlatformTime::Seconds() >= EndTime)
+		{
+			break;
+		}
+	}
+
+	Compact();
+	return NumRun;
+}
+
+//------------------------
+bool FDeprecationPendingUpgrades::HasPendingLoads()
+{
+	check(IsInGameThread());
+
+	FScopeLock ScopeLock(&Lock);
+
+	for (int32 Index = Head; Index < Upgrades.Num(); ++Index)
+	{
+		const FDeprecationPendingUpgradePtr& Upgrade = Upgrades[Index];
+		if (Upgrade.IsValid() && Upgrade->NumPendingLoads.IsValid() && *Upgrade->NumPendingLoads > 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//------------------------
+void FDeprecationPendingUpgrades::WaitForDecoding()
+{
+	// Tasks never lock the list, waiting with the lock held is safe.
+	FScopeLock ScopeLock(&Lock);
+
+	for (int32 Index = Head; Index < Upgrades.Num(); ++Index)
+	{
+		const FDeprecationPendingUpgradePtr& Upgrade = Upgrades[Index];
+		if (Upgrade.IsValid() && Upgrade->DecodeTask.IsValid())
+		{
+			Upgrade->DecodeResult.Wait();
+		}
+	}
+}
+
+//------------------------
+bool FDeprecationPendingUpgrades::IsReady(FDeprecationPendingUpgrade& Upgrade, bool bRequireLoaded)
+{
+	const UObject* Object = Upgrade.Object.Get();
+	if (!Object)
+	{
+		return true;
+	}
+
+	if (bRequireLoaded && Object->HasAnyFlags(RF_NeedLoad | RF_NeedPostLoad))
+	{
+		return false;
+	}
+
+	if (Upgrade.DecodeTask.IsValid())
+	{
+		if (!Upgrade.DecodeResult.IsReady())
+		{
+			return false;
+		}
+
+		Upgrade.TagIndex = MoveTemp(Upgrade.DecodeTask->TagIndex);
+		Upgrade.Tree = MoveTemp(Upgrade.DecodeTask->Tree);
+		Upgrade.DecodeTask.Reset();
+	}
+
+	if (!Upgrade.NumPendingLoads.IsValid())
+	{
+		RequestImports(Upgrade);
+	}
+
+	return *Upgrade.NumPendingLoads == 0;
+}
+
+//------------------------
+void FDeprecationPendingUpgrades::RequestImports(FDeprecationPendingUpgrade& Upgrade)
+{
+	Upgrade.NumPendingLoads = MakeShared<int32>(0);
+
+	TArray<FString> PackageNames;
+	Upgrade.Tree.ResolveImports(0, &PackageNames);
+
+	for (const FString& PackageName : PackageNames)
+	{
+		// Counted before the request, its callback may run right away if the package does not exist.
+		++*Upgrade.NumPendingLoads;
+
+		LoadPackageAsync(PackageName, FLoadPackageAsyncDelegate::CreateLambda(
+			[NumPendingLoads = Upgrade.NumPendingLoads](const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result)
+		{
+			--*NumPendingLoads;
+		}));
+	}
+}
+
+//------------------------
+bool FDeprecationPendingUpgrades::Tick(float DeltaTime)
+{
+	RunReady(CVarPendingUpgradesBudgetMs.GetValueOnGameThread() / 1000.0);
+	return true;
+}
+
+//------------------------
+bool FDeprecationPendingUpgrades::GetUpgrade(int32 Index, FDeprecationPendingUpgradePtr& OutUpgrade)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	if (Index >= Upgrades.Num())
+	{
+		return false;
+	}
+
+	OutUpgrade = Upgrades[Index];
+	return true;
+}
+
+//------------------------
+void FDeprecationPendingUpgrades::RunAt(int32 Index, FDeprecationPendingUpgrade& Upgrade)
+{
+	Upgrade.bIsRunning = true;
+
+	++RunDepth;
+	FDeprecationScope::RunDeferredHandler(Upgrade);
+	--RunDepth;
+
+	FScopeLock ScopeLock(&Lock);
+	Upgrades[Index].Reset();
+	++NumRunUpgrades;
+}
+
+//------------------------
+void FDeprecationPendingUpgrades::Compact()
+{
+	// Indices of the upgrades running must stay valid until they are marked as run.
+	if (RunDepth > 0)
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+
+	while (Head < Upgrades.Num() && !Upgrades[Head].IsValid())
+	{
+		++Head;
+	}
+
+	// Dropped at once when they make most of the list, so the list is never shifted for every upgrade run.
+	if (NumRunUpgrades > Upgrades.Num() / 2)
+	{
+		Upgrades.RemoveAll([](const FDeprecationPendingUpgradePtr& Upgrade)
+		{
+			return !Upgrade.IsValid();
+		});
+
+		Head = 0;
+		NumRunUpgrades = 0;
+	}
+}
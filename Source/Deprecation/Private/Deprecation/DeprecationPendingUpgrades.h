@@ -0,0 +1,209 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "UObject/WeakObjectPtr.h"
+
+#include "Deprecation/DeprecationScope.h"
+#include "Deprecation/DeprecationClassCache.h"
+#include "Deprecation/DeprecationRegistry.h"
+#include "Deprecation/DeprecationSnapshot.h"
+
+/**
+ * Decoding of the tree of a pending upgrade, run on a worker thread from a snapshot of the property data of its object.
+ */
+struct FDeprecationDecodeTask
+{
+	/**
+	 * @param Linker Linker loading the object.
+	 * @param Offset Position in the file of the property data to decode.
+	 * @param Size Size of the property data to decode.
+	 */
+	FDeprecationDecodeTask(FLinkerLoad& Linker, int64 Offset, int64 Size)
+		: Snapshot(Linker, Offset, Size)
+	{
+	}
+
+	FDeprecationSnapshot Snapshot;
+	FDeprecationClassInfoPtr ClassInfo;
+
+	/** Given to the worker thread, moved back to the upgrade once decoded. */
+	FDeprecationTagIndex TagIndex;
+	FDeprecationPropertyTree Tree;
+
+	uint64 AssetVersion = 0;
+	uint64 CodeVersion = 0;
+
+	/** Whether or not to decode the whole root, only the properties declared by the steps otherwise. */
+	bool bDecodeRoot = true;
+
+	/** Key of the tree in the persistent cache, empty if not cached (see FDeprecationTreeCache). */
+	FString CacheKey;
+};
+
+/**
+ * Upgrade whose handler has been deferred out of serialization, with everything needed to run it later.
+ */
+struct FDeprecationPendingUpgrade
+{
+	TWeakObjectPtr<UObject> Object;
+
+	FDeprecationScope::DeprecationHandler Handler = nullptr;
+	FDeprecationScope::LazyDeprecationHandler LazyHandler = nullptr;
+	FDeprecationStepsPtr Steps;
+
+	FDeprecationTagIndex TagIndex;
+	FDeprecationPropertyTree Tree;
+
+	uint64 AssetVersion = 0;
+	uint64 CodeVersion = 0;
+
+	/** Loads of the packages referenced by the tree still in flight, shared with their callbacks. Null until requested. */
+	TSharedPtr<int32> NumPendingLoads;
+
+	/** Decoding of the tree left to a worker thread, null once the tree and the tag index are back in the upgrade. */
+	TSharedPtr<FDeprecationDecodeTask, ESPMode::ThreadSafe> DecodeTask;
+	TFuture<void> DecodeResult;
+
+	/** Set while its handler runs, the upgrade stays listed (and its object pending) until it has run. */
+	bool bIsRunning = false;
+};
+
+typedef TSharedPtr<FDeprecationPendingUpgrade, ESPMode::ThreadSafe> FDeprecationPendingUpgradePtr;
+
+/**
+ * Thread-safe list of the upgrades deferred while loading on the async loading thread.
+ * Upgrades are run on the game thread, from PostLoad or by a ticker once their object is fully loaded
+ * and the packages referenced by their tree have been loaded, all requested at once.
+ * Upgrades are run in place, in the order they have been added, and dropped from the list in batches.
+ */
+class FDeprecationPendingUpgrades final
+{
+	// Constructors
+private:
+	FDeprecationPendingUpgrades() = default;
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Returns the instance of the list.
+	 */
+	static FDeprecationPendingUpgrades& Get();
+
+	/**
+	 * Registers the ticker running the upgrades left pending.
+	 */
+	void Initialize();
+
+	/**
+	 * Unregisters the ticker and drops the pending upgrades.
+	 */
+	void Shutdown();
+
+	/**
+	 * Adds an upgrade to run later, can be called from any thread.
+	 * @param Upgrade Upgrade to run.
+	 */
+	void Add(FDeprecationPendingUpgrade&& Upgrade);
+
+	/**
+	 * Runs the pending upgrades of an object, must be called on the game thread.
+	 * Upgrades waiting for the packages they reference are left to the ticker.
+	 * @param Object Object to upgrade.
+	 * @returns True if at least one upgrade has been run, false otherwise.
+	 */
+	bool Run(const UObject* Object);
+
+	/**
+	 * Runs the pending upgrades of the objects that are fully loaded, must be called on the game thread.
+	 * @param MaxSeconds Time after which the remaining upgrades are left for later, 0 for no limit. At least one upgrade is run.
+	 * @returns Number of upgrades run.
+	 */
+	int32 RunReady(double MaxSeconds = 0.0);
+
+	/**
+	 * Checks if an object has an upgrade waiting to run.
+	 * @param Object Object to check.
+	 */
+	bool Contains(const UObject* Object);
+
+	/**
+	 * Finds the version of the asset an object has been loaded from, while its upgrades are pending.
+	 * @param Object Object to look for.
+	 * @param OutAssetVersion Version of the asset, the one of the first pending upgrade of the object.
+	 * @returns True if the object has an upgrade waiting to run, false otherwise.
+	 */
+	bool FindAssetVersion(const UObject* Object, uint64& OutAssetVersion);
+
+	/**
+	 * Checks if upgrades are waiting for the packages they reference, must be called on the game thread.
+	 */
+	bool HasPendingLoads();
+
+	/**
+	 * Waits for the trees still decoded on worker threads.
+	 */
+	void WaitForDecoding();
+
+private:
+	/**
+	 * Checks if an upgrade can run, requesting the packages its tree references the first time its object is ready
+	 * and its tree has been decoded.
+	 * @param Upgrade Upgrade to check.
+	 * @param bRequireLoaded Whether or not the object must be fully loaded (not needed from its own PostLoad).
+	 * @returns True if the upgrade can run (or its object is gone), false otherwise.
+	 */
+	static bool IsReady(FDeprecationPendingUpgrade& Upgrade, bool bRequireLoaded);
+
+	/**
+	 * Requests the packages referenced by the tree of an upgrade, in one batch of async loads.
+	 * @param Upgrade Upgrade to request packages for.
+	 */
+	static void RequestImports(FDeprecationPendingUpgrade& Upgrade);
+
+	/**
+	 * Runs the ready upgrades from the core ticker.
+	 */
+	bool Tick(float DeltaTime);
+
+	/**
+	 * Gets an upgrade of the list, can be called from any thread.
+	 * @param Index Index of the upgrade in the list.
+	 * @param OutUpgrade Receives the upgrade, null if it has already run.
+	 * @returns False if the index is past the end of the list, true otherwise.
+	 */
+	bool GetUpgrade(int32 Index, FDeprecationPendingUpgradePtr& OutUpgrade);
+
+	/**
+	 * Runs an upgrade of the list, then marks it as run. Must be called on the game thread.
+	 * @param Index Index of the upgrade in the list.
+	 * @param Upgrade Upgrade to run.
+	 */
+	void RunAt(int32 Index, FDeprecationPendingUpgrade& Upgrade);
+
+	/**
+	 * Skips the upgrades run at the head of the list, and drops the run ones once they make most of it.
+	 * Indices are only stable until then, it does nothing while an upgrade is running.
+	 */
+	void Compact();
+
+
+
+
+	// Fields
+private:
+	FCriticalSection Lock;
+
+	/** Upgrades in the order they have been added, null once run. Every upgrade before Head has run. */
+	TArray<FDeprecationPendingUpgradePtr> Upgrades;
+	int32 Head = 0;
+	int32 NumRunUpgrades = 0;
+
+	/** Number of upgrades running (handlers may run others), game thread only. */
+	int32 RunDepth = 0;
+
+	FDelegateHandle TickerHandle;
+};
@@ -0,0 +1,249 @@
+#include "Deprecation/DeprecationProperty.h"
+
+//------------------------
+namespace
+{
+	//------------------------
+	template <typename T>
+	void* CopyPayload(const void* Payload, bool& bOutOwnsPayload)
+	{
+		if (FDeprecationArena* Arena = FDeprecationArena::GetCurrent())
+		{
+			bOutOwnsPayload = false;
+			return Arena->New<T>(*(const T*)Payload);
+		}
+
+		bOutOwnsPayload = true;
+		return new T(*(const T*)Payload);
+	}
+
+	//------------------------
+	template <typename T>
+	void DeletePayload(void* Payload)
+	{
+		delete (T*)Payload;
+	}
+
+	//------------------------
+	TCHAR* CopyString(FStringView Value, bool& bOutOwnsPayload)
+	{
+		const SIZE_T Size = (Value.Len() + 1) * sizeof(TCHAR);
+
+		TCHAR* Data;
+		if (FDeprecationArena* Arena = FDeprecationArena::GetCurrent())
+		{
+			Data = (TCHAR*)Arena->Alloc(Size, alignof(TCHAR));
+			bOutOwnsPayload = false;
+		}
+		else
+		{
+			Data = (TCHAR*)FMemory::Malloc(Size, alignof(TCHAR));
+			bOutOwnsPayload = true;
+		}
+
+		FMemory::Memcpy(Data, Value.GetData(), Value.Len() * sizeof(TCHAR));
+		Data[Value.Len()] = TCHAR('\0');
+		return Data;
+	}
+}
+
+//------------------------
+void FDeprecationProperty::Variant::Reset()
+{
+	// Project structures are destroyed with the variant, wherever their memory comes from.
+	if (Type == EDeprecationVariantType::Struct)
+	{
+		const FStructPayload StructPayload = GetUnchecked<FStructPayload>(FInlineTag());
+		if (bOwnsPayload)
+		{
+			StructPayload.Ops->Delete(StructPayload.Data);
+		}
+		else
+		{
+			StructPayload.Ops->Destruct(StructPayload.Data);
+		}
+	}
+
+	// Other payloads allocated in an arena are released with it.
+	switch (bOwnsPayload ? Type : EDeprecationVariantType::None)
+	{
+		// Types stored out of line (see TIsInline).
+	case EDeprecationVariantType::Box:			DeletePayload<FBox>(Payload); break;
+	case EDeprecationVariantType::Box2D:		DeletePayload<FBox2D>(Payload); break;
+	case EDeprecationVariantType::Matrix:		DeletePayload<FMatrix>(Payload); break;
+	case EDeprecationVariantType::Transform:	DeletePayload<FTransform>(Payload); break;
+	case EDeprecationVariantType::BoxSphereBounds:	DeletePayload<FBoxSphereBounds>(Payload); break;
+	case EDeprecationVariantType::ObjectImport:	DeletePayload<FObjectImport>(Payload); break;
+
+		// Characters of strings are referenced by the first bytes of the storage.
+	case EDeprecationVariantType::String:
+	case EDeprecationVariantType::SoftObjectPath:
+		FMemory::Free(GetUnchecked<FStringPayload>(FInlineTag()).Data);
+		break;
+
+	default: break;
+	}
+
+	Type = EDeprecationVariantType::None;
+	bOwnsPayload = false;
+	FMemory::Memzero(Storage);
+}
+
+//------------------------
+FDeprecationProperty::Variant& FDeprecationProperty::Variant::operator=(const Variant& Other)
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	Reset();
+
+	switch (Other.Type)
+	{
+	case EDeprecationVariantType::Box:			Payload = CopyPayload<FBox>(Other.Payload, bOwnsPayload); break;
+	case EDeprecationVariantType::Box2D:		Payload = CopyPayload<FBox2D>(Other.Payload, bOwnsPayload); break;
+	case EDeprecationVariantType::Matrix:		Payload = CopyPayload<FMatrix>(Other.Payload, bOwnsPayload); break;
+	case EDeprecationVariantType::Transform:	Payload = CopyPayload<FTransform>(Other.Payload, bOwnsPayload); break;
+	case EDeprecationVariantType::BoxSphereBounds:	Payload = CopyPayload<FBoxSphereBounds>(Other.Payload, bOwnsPayload); break;
+	case EDeprecationVariantType::ObjectImport:	Payload = CopyPayload<FObjectImport>(Other.Payload, bOwnsPayload); break;
+	case EDeprecationVariantType::Struct:
+		{
+			const FStructPayload StructPayload = Other.GetUnchecked<FStructPayload>(FInlineTag());
+			SetStructUnchecked(StructPayload.Data, StructPayload.Ops);
+		}
+		break;
+	case EDeprecationVariantType::String:
+	case EDeprecationVariantType::SoftObjectPath:
+		SetStringUnchecked(Other.GetStringView(), Other.Type);
+		break;
+	default: FMemory::Memcpy(Storage, Other.Storage); break;
+	}
+
+	Type = Other.Type;
+	return *this;
+}
+
+//------------------------
+void FDeprecationProperty::Variant::SetStringUnchecked(FStringView Value, EDeprecationVariantType StringType)
+{
+	Reset();
+
+	FStringPayload StringPayload;
+	StringPayload.Data = CopyString(Value, bOwnsPayload);
+	StringPayload.Len = Value.Len();
+
+	SetUnchecked(StringPayload, FInlineTag());
+	Type = StringType;
+}
+
+//------------------------
+void FDeprecationProperty::Variant::SetStructUnchecked(const void* Data, const FDeprecationStructOps* Ops)
+{
+	Reset();
+
+	FStructPayload StructPayload;
+	StructPayload.Data = Ops->Copy(Data, bOwnsPayload);
+	StructPayload.Ops = Ops;
+
+	SetUnchecked(StructPayload, FInlineTag());
+	Type = EDeprecationVariantType::Struct;
+}
+
+//------------------------
+FDeprecationProperty::Variant& FDeprecationProperty::Variant::operator=(Variant&& Other)
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	Reset();
+
+	// Out of line payloads are held by pointer, so stealing the storage is enough.
+	FMemory::Memcpy(Storage, Other.Storage);
+	Type = Other.Type;
+	bOwnsPayload = Other.bOwnsPayload;
+
+	Other.Type = EDeprecationVariantType::None;
+	Other.bOwnsPayload = false;
+	FMemory::Memzero(Other.Storage);
+
+	return *this;
+}
+
+//------------------------
+void FDeprecationProperty::UnpackValue(EDeprecationVariantType Type, const uint8* PackedValue, Variant& OutValue)
+{
+	switch (Type)
+	{
+#define PACKED_TYPE(VariantType, CppType) case EDeprecationVariantType::VariantType: OutValue.Set(*(const CppType*)PackedValue); break;
+
+		PACKED_TYPE(Bool, bool);
+		PACKED_TYPE(Int8, int8);
+		PACKED_TYPE(Int16, int16);
+		PACKED_TYPE(Int32, int32);
+		PACKED_TYPE(Int64, int64);
+		PACKED_TYPE(UInt8, uint8);
+		PACKED_TYPE(UInt16, uint16);
+		PACKED_TYPE(UInt32, uint32);
+		PACKED_TYPE(UInt64, uint64);
+		PACKED_TYPE(Float, float);
+		PACKED_TYPE(Double, double);
+
+		PACKED_TYPE(Vector2D, FVector2D);
+		PACKED_TYPE(IntRect, FIntRect);
+		PACKED_TYPE(IntPoint, FIntPoint);
+		PACKED_TYPE(Vector4, FVector4);
+		PACKED_TYPE(Vector, FVector);
+		PACKED_TYPE(Rotator, FRotator);
+		PACKED_TYPE(Color, FColor);
+		PACKED_TYPE(Plane, FPlane);
+		PACKED_TYPE(Matrix, FMatrix);
+		PACKED_TYPE(LinearColor, FLinearColor);
+		PACKED_TYPE(Quat, FQuat);
+		PACKED_TYPE(Sphere, FSphere);
+		PACKED_TYPE(BoxSphereBounds, FBoxSphereBounds);
+
+#undef PACKED_TYPE
+
+	default: checkNoEntry(); break;
+	}
+}
+
+//------------------------
+int32 FDeprecationProperty::GetPackedSize(EDeprecationVariantType Type)
+{
+	switch (Type)
+	{
+	case EDeprecationVariantType::Bool:		return sizeof(bool);
+	case EDeprecationVariantType::Int8:		return sizeof(int8);
+	case EDeprecationVariantType::Int16:	return sizeof(int16);
+	case EDeprecationVariantType::Int32:	return sizeof(int32);
+	case EDeprecationVariantType::Int64:	return sizeof(int64);
+	case EDeprecationVariantType::UInt8:	return sizeof(uint8);
+	case EDeprecationVariantType::UInt16:	return sizeof(uint16);
+	case EDeprecationVariantType::UInt32:	return sizeof(uint32);
+	case EDeprecationVariantType::UInt64:	return sizeof(uint64);
+	case EDeprecationVariantType::Float:	return sizeof(float);
+	case EDeprecationVariantType::Double:	return sizeof(double);
+
+	case EDeprecationVariantType::Vector2D:			return sizeof(FVector2D);
+	case EDeprecationVariantType::IntRect:			return sizeof(FIntRect);
+	case EDeprecationVariantType::IntPoint:			return sizeof(FIntPoint);
+	case EDeprecationVariantType::Vector4:			return sizeof(FVector4);
+	case EDeprecationVariantType::Vector:			return sizeof(FVector);
+	case EDeprecationVariantType::Rotator:			return sizeof(FRotator);
+	case EDeprecationVariantType::Color:			return sizeof(FColor);
+	case EDeprecationVariantType::Plane:			return sizeof(FPlane);
+	case EDeprecationVariantType::Matrix:			return sizeof(FMatrix);
+	case EDeprecationVariantType::LinearColor:		return sizeof(FLinearColor);
+	case EDeprecationVariantType::Quat:				return sizeof(FQuat);
+	case EDeprecationVariantType::Sphere:			return sizeof(FSphere);
+	case EDeprecationVariantType::BoxSphereBounds:	return sizeof(FBoxSphereBounds);
+	default: break;
+	}
+
+	checkNoEntry();
+	return 1;
+}
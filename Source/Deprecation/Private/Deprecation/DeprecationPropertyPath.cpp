@@ -0,0 +1,128 @@
+#include "Deprecation/DeprecationPropertyPath.h"
+
+//------------------------
+namespace
+{
+	//------------------------
+	bool IsValidIndex(FStringView IndexString)
+	{
+		// Up to 9 digits, so the index never overflows.
+		if (IndexString.Len() == 0 || IndexString.Len() > 9)
+		{
+			return false;
+		}
+
+		for (int32 CharIndex = 0; CharIndex < IndexString.Len(); ++CharIndex)
+		{
+			if (!FChar::IsDigit(IndexString[CharIndex]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+//------------------------
+FDeprecationPropertyPath::FDeprecationPropertyPath(FStringView Path)
+{
+	Parse(Path);
+}
+
+//------------------------
+FDeprecationPropertyPath::FDeprecationPropertyPath(const TCHAR* Path)
+{
+	Parse(FStringView(Path));
+}
+
+//------------------------
+FDeprecationPropertyPath::FDeprecationPropertyPath(const ANSICHAR* Path)
+{
+	const FString WidePath(Path);
+	Parse(FStringView(WidePath));
+}
+
+//------------------------
+const FDeprecationProperty* FDeprecationPropertyPath::Resolve(const FDeprecationProperty::Map& Root, int32& OutIndex) const
+{
+	if (Segments.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	const FDeprecationProperty* RootProperty = Root.Find(Segments[0].Name);
+	return RootProperty ? Resolve(*RootProperty, OutIndex) : nullptr;
+}
+
+//------------------------
+const FDeprecationProperty* FDeprecationPropertyPath::Resolve(const FDeprecationProperty& RootProperty, int32& OutIndex) const
+{
+	const FDeprecationProperty* Property = &RootProperty;
+
+	for (int32 SegmentIndex = 1; SegmentIndex < Segments.Num(); ++SegmentIndex)
+	{
+		// Going through a structure value, held as a nested map.
+		const int32 ValueIndex = FMath::Max(Segments[SegmentIndex - 1].Index, 0);
+		if (Property->IsPacked() || !Property->Values.IsValidIndex(ValueIndex))
+		{
+			return nullptr;
+		}
+
+		const FDeprecationProperty::Variant& Value = Property->Values[ValueIndex];
+		if (Value.GetType() != EDeprecationVariantType::Properties)
+		{
+			return nullptr;
+		}
+
+		Property = Value.GetProperties()->Find(Segments[SegmentIndex].Name);
+		if (!Property)
+		{
+			return nullptr;
+		}
+	}
+
+	OutIndex = Segments.Num() > 0 ? FMath::Max(Segments.Last().Index, 0) : 0;
+	return Property;
+}
+
+//------------------------
+void FDeprecationPropertyPath::Parse(FStringView Path)
+{
+	while (Path.Len() > 0)
+	{
+		int32 DotIndex;
+		const FStringView Element = Path.FindChar(TCHAR('.'), DotIndex) ? Path.Left(DotIndex) : Path;
+		Path.RightChopInline(DotIndex != INDEX_NONE ? DotIndex + 1 : Path.Len());
+
+		FStringView Name = Element;
+		int32 Index = INDEX_NONE;
+
+		int32 BracketIndex;
+		if (Element.FindChar(TCHAR('['), BracketIndex))
+		{
+			Name = Element.Left(BracketIndex);
+
+			const bool bIsClosed = BracketIndex < Element.Len() - 1 && Element[Element.Len() - 1] == TCHAR(']');
+			const FStringView IndexString = bIsClosed ? Element.Mid(BracketIndex + 1, Element.Len() - BracketIndex - 2) : FStringView();
+			if (!ensureMsgf(bIsClosed && IsValidIndex(IndexString),
+				TEXT("Invalid index in deprecation path element '%s', indices are non-negative numbers."), *FString(Element)))
+			{
+				Segments.Reset();
+				return;
+			}
+
+			Index = FCString::Atoi(*FString(IndexString));
+		}
+
+		if (!ensureMsgf(Name.Len() > 0, TEXT("Empty property name in deprecation path.")))
+		{
+			Segments.Reset();
+			return;
+		}
+
+		FSegment& Segment = Segments.AddDefaulted_GetRef();
+		Segment.Name = FName(Name.Len(), Name.GetData());
+		Segment.Index = Index;
+	}
+}
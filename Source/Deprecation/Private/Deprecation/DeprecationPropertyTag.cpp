@@ -85,7 +85,7 @@ void operator<<(FStructuredArchive::FSlot Slot, FDeprecationPropertyTag& Tag)
 
 	int32 Version = UnderlyingArchive.UE4Ver();
 
-	check(!UnderlyingArchive.GetArchiveState().UseUnversionedPropertySerialization());
+	checkf(!UnderlyingArchive.GetArchiveState().UseUnversionedPropertySerialization(), TEXT("Unversioned properties have no tags, FDeprecationScope reads them through the schema of the class instead."));
 	checkf(!UnderlyingArchive.IsSaving() || Tag.Prop, TEXT("FDeprecationPropertyTag must be constructed with a valid property when used for saving data!"));
 
 	if (!bIsTextFormat)
@@ -0,0 +1,98 @@
+#include "Deprecation/DeprecationPropertyTree.h"
+
+#include "Misc/PackageName.h"
+
+//------------------------
+FDeprecationPropertyTree::FDeprecationPropertyTree()
+	: Arena(MakeUnique<FDeprecationArena>())
+{
+}
+
+//------------------------
+FDeprecationPropertyTree::FDeprecationPropertyTree(FDeprecationPropertyTree&& Other)
+	: Arena(MoveTemp(Other.Arena))
+	, Root(MoveTemp(Other.Root))
+	, Imports(MoveTemp(Other.Imports))
+{
+	// The moved-from tree stays usable.
+	Other.Arena = MakeUnique<FDeprecationArena>();
+}
+
+//------------------------
+FDeprecationPropertyTree::~FDeprecationPropertyTree()
+{
+}
+
+//------------------------
+FDeprecationProperty::Map* FDeprecationPropertyTree::NewMap()
+{
+	return Arena->New<FDeprecationProperty::Map>();
+}
+
+//------------------------
+void FDeprecationPropertyTree::AddImport(FObjectImport& ObjectImport, FSoftObjectPath&& Path)
+{
+	FImport& Import = Imports.AddDefaulted_GetRef();
+	Import.ObjectImport = &ObjectImport;
+	Import.Path = MoveTemp(Path);
+}
+
+//------------------------
+int32 FDeprecationPropertyTree::ResolveImports(int32 FirstImport, TArray<FString>* OutPackageNames)
+{
+	check(IsInGameThread());
+
+	int32 NumUnresolvedImports = 0;
+
+	for (int32 Index = FirstImport; Index < Imports.Num(); ++Index)
+	{
+		FImport& Import = Imports[Index];
+		if (Import.ObjectImport->XObject)
+		{
+			continue;
+		}
+
+		Import.ObjectImport->XObject = Import.Path.ResolveObject();
+		if (Import.ObjectImport->XObject)
+		{
+			continue;
+		}
+
+		++NumUnresolvedImports;
+
+		// Script packages are always in memory, an object missing from them can not be loaded.
+		const FString PackageName = Import.Path.GetLongPackageName();
+		if (OutPackageNames && !PackageName.IsEmpty() && !FPackageName::IsScriptPackage(PackageName))
+		{
+			OutPackageNames->AddUnique(PackageName);
+		}
+	}
+
+	return NumUnresolvedImports;
+}
+
+//------------------------
+void FDeprecationPropertyTree::Reset()
+{
+	Root.Empty();
+	Imports.Empty();
+	Arena->Reset();
+}
+
+//------------------------
+FDeprecationPropertyTree& FDeprecationPropertyTree::operator=(FDeprecationPropertyTree&& Other)
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	Root.Empty();
+	Root = MoveTemp(Other.Root);
+	Imports = MoveTemp(Other.Imports);
+	Swap(Arena, Other.Arena);
+
+	// Our previous data now belongs to the other tree, released right away.
+	Other.Reset();
+	return *this;
+}
@@ -0,0 +1,103 @@
+#include "Deprecation/DeprecationPropertyVisitor.h"
+
+//------------------------
+void IDeprecationPropertyVisitor::Visit(const FDeprecationProperty::Map& Map)
+{
+	for (const TPair<FName, FDeprecationProperty>& Pair : Map)
+	{
+		Visit(Pair.Value);
+	}
+}
+
+//------------------------
+void IDeprecationPropertyVisitor::Visit(const FDeprecationProperty& Property)
+{
+	if (!BeginProperty(Property.PropertyName, Property.PropertyTypeName))
+	{
+		return;
+	}
+
+	if (Property.PropertyTypeName == NAME_ArrayProperty)
+	{
+		BeginArray(Property.InnerTypeName, Property.NumValues());
+		VisitDecodedValues(Property);
+		EndArray();
+	}
+	else if (Property.PropertyTypeName == NAME_SetProperty)
+	{
+		BeginSet(Property.InnerTypeName, Property.NumValues());
+		VisitDecodedValues(Property);
+		EndSet();
+	}
+	else if (Property.PropertyTypeName == NAME_MapProperty)
+	{
+		BeginMap(Property.InnerTypeName, Property.MapValueTypeName, Property.Keys.Num());
+
+		for (int32 Index = 0; Index < Property.Keys.Num(); ++Index)
+		{
+			VisitDecodedValue(Property.Keys[Index], NAME_None);
+			VisitDecodedValue(Property.Values[Index], NAME_None);
+		}
+
+		EndMap();
+	}
+	else if (Property.HasValue())
+	{
+		VisitDecodedValue(Property.Values[0], Property.StructTypeName);
+	}
+
+	EndProperty(Property.PropertyName);
+}
+
+//------------------------
+void IDeprecationPropertyVisitor::VisitPackedValues(EDeprecationVariantType Type, const uint8* Values, int32 Num)
+{
+	const int32 PackedSize = FDeprecationProperty::GetPackedSize(Type);
+
+	FDeprecationProperty::Variant Value;
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		FDeprecationProperty::UnpackValue(Type, Values + Index * PackedSize, Value);
+		VisitValue(Value);
+	}
+}
+
+//------------------------
+void IDeprecationPropertyVisitor::VisitDecodedValues(const FDeprecationProperty& Property)
+{
+	if (Property.IsPacked())
+	{
+		VisitPackedValues(Property.PackedValueType, Property.PackedValues.GetData(), Property.NumValues());
+		return;
+	}
+
+	for (const FDeprecationProperty::Variant& Value : Property.Values)
+	{
+		VisitDecodedValue(Value, Property.StructTypeName);
+	}
+}
+
+//------------------------
+void IDeprecationPropertyVisitor::VisitDecodedValue(const FDeprecationProperty::Variant& Value, FName StructName)
+{
+	switch (Value.GetType())
+	{
+	case EDeprecationVariantType::None:
+		break;
+
+	case EDeprecationVariantType::Properties:
+		BeginStruct(StructName);
+		Visit(*Value.GetProperties());
+		EndStruct();
+		break;
+
+	case EDeprecationVariantType::String:			VisitString(Value.GetStringView()); break;
+	case EDeprecationVariantType::SoftObjectPath:	VisitSoftObjectPath(Value.GetStringView()); break;
+	case EDeprecationVariantType::ObjectImport:		VisitObject(&Value.Get<FObjectImport>(), nullptr); break;
+	case EDeprecationVariantType::Object:			VisitObject(nullptr, Value.Get<UObject*>()); break;
+
+	default:
+		VisitValue(Value);
+		break;
+	}
+}
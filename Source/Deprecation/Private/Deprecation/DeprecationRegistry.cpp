@@ -0,0 +1,149 @@
+#include "Deprecation/DeprecationRegistry.h"
+
+#include "Deprecation/DeprecationClassCache.h"
+
+#include "Misc/CoreDelegates.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/Class.h"
+
+//------------------------
+FDeprecationRegistry& FDeprecationRegistry::Get()
+{
+	static FDeprecationRegistry Instance;
+	return Instance;
+}
+
+//------------------------
+void FDeprecationRegistry::Initialize()
+{
+	// Classes of every module are registered by then, including the game ones.
+	PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddLambda([this]()
+	{
+		Validate();
+	});
+}
+
+//------------------------
+void FDeprecationRegistry::Shutdown()
+{
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+}
+
+//------------------------
+void FDeprecationRegistry::AddFieldRules(FDeprecationFieldRules::ClassGetter GetClass, const TCHAR* VersionPropertyName, FDeprecationFieldRules::RegisterFunction Register)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	FFieldRulesRegistration& Registration = FieldRulesRegistrations.AddDefaulted_GetRef();
+	Registration.GetClass = GetClass;
+	Registration.VersionPropertyName = VersionPropertyName;
+	Registration.Register = Register;
+}
+
+//------------------------
+FDeprecationFieldRulesPtr FDeprecationRegistry::BuildFieldRules(const UClass* Class, FName VersionPropertyName)
+{
+	TSharedRef<FDeprecationFieldRules, ESPMode::ThreadSafe> Rules = MakeShared<FDeprecationFieldRules, ESPMode::ThreadSafe>();
+
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		for (const FFieldRulesRegistration& Registration : FieldRulesRegistrations)
+		{
+			if (VersionPropertyName == Registration.VersionPropertyName && Class->IsChildOf(Registration.GetClass()))
+			{
+				Registration.Register(*Rules);
+			}
+		}
+	}
+
+	if (Rules->IsEmpty())
+	{
+		return nullptr;
+	}
+
+	Rules->Sort();
+	return Rules;
+}
+
+//------------------------
+void FDeprecationRegistry::AddSteps(FDeprecationSteps::ClassGetter GetClass, const TCHAR* VersionPropertyName, FDeprecationSteps::RegisterFunction Register)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	FStepsRegistration& Registration = StepsRegistrations.AddDefaulted_GetRef();
+	Registration.GetClass = GetClass;
+	Registration.VersionPropertyName = VersionPropertyName;
+	Registration.Register = Register;
+}
+
+//------------------------
+FDeprecationStepsPtr FDeprecationRegistry::BuildSteps(const UClass* Class, FName VersionPropertyName)
+{
+	TSharedRef<FDeprecationSteps, ESPMode::ThreadSafe> Steps = MakeShared<FDeprecationSteps, ESPMode::ThreadSafe>();
+
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		for (const FStepsRegistration& Registration : StepsRegistrations)
+		{
+			if (VersionPropertyName == Registration.VersionPropertyName && Class->IsChildOf(Registration.GetClass()))
+			{
+				Registration.Register(*Steps);
+			}
+		}
+	}
+
+	if (Steps->IsEmpty())
+	{
+		return nullptr;
+	}
+
+	Steps->Sort();
+	return Steps;
+}
+
+//------------------------
+void FDeprecationRegistry::GetVersionPropertyNames(TArray<FName>& OutNames)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	for (const FFieldRulesRegistration& Registration : FieldRulesRegistrations)
+	{
+		OutNames.AddUnique(Registration.VersionPropertyName);
+	}
+	for (const FStepsRegistration& Registration : StepsRegistrations)
+	{
+		OutNames.AddUnique(Registration.VersionPropertyName);
+	}
+}
+
+//------------------------
+bool FDeprecationRegistry::Validate()
+{
+	TArray<TPair<UClass*, FName>> Classes;
+
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		for (const FFieldRulesRegistration& Registration : FieldRulesRegistrations)
+		{
+			Classes.AddUnique(TPair<UClass*, FName>(Registration.GetClass(), Registration.VersionPropertyName));
+		}
+		for (const FStepsRegistration& Registration : StepsRegistrations)
+		{
+			Classes.AddUnique(TPair<UClass*, FName>(Registration.GetClass(), Registration.VersionPropertyName));
+		}
+	}
+
+	bool bIsValid = true;
+
+	for (const TPair<UClass*, FName>& Class : Classes)
+	{
+		// Building the class info checks the declarations against the class.
+		const FDeprecationClassInfoPtr Info = FDeprecationClassCache::Get().FindOrAdd(Class.Key, Class.Value);
+		bIsValid &= Info->VersionProperty && Info->bHasValidFieldRules && Info->bHasValidSteps;
+	}
+
+	return bIsValid;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Deprecation/DeprecationFieldRules.h"
+#include "Deprecation/DeprecationSteps.h"
+
+typedef TSharedPtr<const FDeprecationFieldRules, ESPMode::ThreadSafe> FDeprecationFieldRulesPtr;
+typedef TSharedPtr<const FDeprecationSteps, ESPMode::ThreadSafe> FDeprecationStepsPtr;
+
+/**
+ * Declarations registered at static initialization time by the classes using deprecation scopes.
+ * Registrations only hold function pointers, they are turned into data once UObjects are initialized.
+ */
+class FDeprecationRegistry final
+{
+	// Typedefs
+private:
+	struct FFieldRulesRegistration
+	{
+		FDeprecationFieldRules::ClassGetter GetClass;
+		const TCHAR* VersionPropertyName;
+		FDeprecationFieldRules::RegisterFunction Register;
+	};
+
+	struct FStepsRegistration
+	{
+		FDeprecationSteps::ClassGetter GetClass;
+		const TCHAR* VersionPropertyName;
+		FDeprecationSteps::RegisterFunction Register;
+	};
+
+
+
+
+	// Constructors
+private:
+	FDeprecationRegistry() = default;
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Returns the instance of the registry.
+	 */
+	static FDeprecationRegistry& Get();
+
+	/**
+	 * Registers the validation of the declarations, once every module is loaded.
+	 */
+	void Initialize();
+
+	/**
+	 * Unregisters the validation.
+	 */
+	void Shutdown();
+
+	/**
+	 * Adds the field rules of a class, can be called during static initialization.
+	 * @param GetClass Function returning the class of the rules.
+	 * @param VersionPropertyName Name of the property holding the deprecation version the rules refer to.
+	 * @param Register Function adding the rules.
+	 */
+	void AddFieldRules(FDeprecationFieldRules::ClassGetter GetClass, const TCHAR* VersionPropertyName, FDeprecationFieldRules::RegisterFunction Register);
+
+	/**
+	 * Builds the field rules of a class, including the ones of its super classes.
+	 * @param Class Class to build the rules for.
+	 * @param VersionPropertyName Name of the property holding the deprecation version.
+	 * @returns The rules sorted by version, nullptr if the class has none.
+	 */
+	FDeprecationFieldRulesPtr BuildFieldRules(const UClass* Class, FName VersionPropertyName);
+
+	/**
+	 * Adds the steps of a class, can be called during static initialization.
+	 * @param GetClass Function returning the class of the steps.
+	 * @param VersionPropertyName Name of the property holding the deprecation version the steps refer to.
+	 * @param Register Function adding the steps.
+	 */
+	void AddSteps(FDeprecationSteps::ClassGetter GetClass, const TCHAR* VersionPropertyName, FDeprecationSteps::RegisterFunction Register);
+
+	/**
+	 * Builds the chain of steps of a class, including the ones of its super classes.
+	 * @param Class Class to build the chain for.
+	 * @param VersionPropertyName Name of the property holding the deprecation version.
+	 * @returns The steps sorted by version, nullptr if the class has none.
+	 */
+	FDeprecationStepsPtr BuildSteps(const UClass* Class, FName VersionPropertyName);
+
+	/**
+	 * Collects the names of the version properties the declarations refer to.
+	 * @param OutNames Receives the names, without duplicates.
+	 */
+	void GetVersionPropertyNames(TArray<FName>& OutNames);
+
+	/**
+	 * Checks every declaration against the reflected classes, reporting errors through ensures.
+	 * @returns True if every declaration is valid, false otherwise.
+	 */
+	bool Validate();
+
+
+
+
+	// Fields
+private:
+	FCriticalSection Lock;
+	TArray<FFieldRulesRegistration> FieldRulesRegistrations;
+	TArray<FStepsRegistration> StepsRegistrations;
+
+	FDelegateHandle PostEngineInitHandle;
+};
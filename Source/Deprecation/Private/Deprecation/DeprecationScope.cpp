@@ -2,80 +2,1682 @@
 
 #include "Deprecation/DeprecationScope.h"
 
+#include "Deprecation/DeprecationClassCache.h"
+#include "Deprecation/DeprecationPendingUpgrades.h"
+#include "Deprecation/DeprecationSnapshot.h"
+#include "Deprecation/DeprecationStructDecoders.h"
+#include "Deprecation/DeprecationTreeCache.h"
+
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ByteSwap.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
 #include "UObject/LinkerLoad.h"
 #include "UObject/NoExportTypes.h"
 #include "UObject/UnrealType.h"
 
+DECLARE_STATS_GROUP(TEXT("Deprecation"), STATGROUP_Deprecation, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Probe"), STAT_Deprecation_Probe, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Complete Tag Index"), STAT_Deprecation_CompleteTagIndex, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Generate Root"), STAT_Deprecation_GenerateRoot, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Snapshot"), STAT_Deprecation_Snapshot, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Decode Snapshot"), STAT_Deprecation_DecodeSnapshot, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Load Cached Tree"), STAT_Deprecation_LoadCachedTree, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Save Cached Tree"), STAT_Deprecation_SaveCachedTree, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Field Rules"), STAT_Deprecation_FieldRules, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Resolve Imports"), STAT_Deprecation_ResolveImports, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Handler"), STAT_Deprecation_Handler, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Step"), STAT_Deprecation_Step, STATGROUP_Deprecation);
+DECLARE_CYCLE_STAT(TEXT("Visit"), STAT_Deprecation_Visit, STATGROUP_Deprecation);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Assets Upgraded"), STAT_Deprecation_NumUpgraded, STATGROUP_Deprecation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Assets Skipped"), STAT_Deprecation_NumSkipped, STATGROUP_Deprecation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Properties Decoded"), STAT_Deprecation_NumPropertiesDecoded, STATGROUP_Deprecation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Nested Maps"), STAT_Deprecation_NumNestedMaps, STATGROUP_Deprecation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cached Trees Loaded"), STAT_Deprecation_NumCacheHits, STATGROUP_Deprecation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Import Packages Loaded"), STAT_Deprecation_NumImportPackagesLoaded, STATGROUP_Deprecation);
+DECLARE_MEMORY_STAT(TEXT("Bytes Decoded"), STAT_Deprecation_NumBytesDecoded, STATGROUP_Deprecation);
+
+//------------------------
+namespace
+{
+	//------------------------
+	TAutoConsoleVariable<int32> CVarMaxDecodedBytesPerObject(
+		TEXT("Deprecation.MaxDecodedBytesPerObject"),
+		0,
+		TEXT("Largest serialized size of the properties decoded for the upgrade of a single object, 0 for no limit.\n")
+		TEXT("Objects needing more are left at the version of their asset."));
+
+	//------------------------
+	TAutoConsoleVariable<int32> CVarQueueUpgrades(
+		TEXT("Deprecation.QueueUpgrades"),
+		0,
+		TEXT("Queues the upgrades of the objects being loaded instead of running them during serialization (e.g. when streaming levels).\n")
+		TEXT("Their properties are decoded on worker threads when loaded from a package, their handlers run on the game thread\n")
+		TEXT("within Deprecation.PendingUpgradesBudgetMs. Objects are pending upgrade until then (see FDeprecationScope::IsUpgradePending)."));
+
+	//------------------------
+	FDeprecationProperty& MakeProperty(
+		FDeprecationProperty::Map& TargetMap, FDeprecationPropertyTag& Tag)
+	{
+		FDeprecationProperty& DeprProperty = TargetMap.Add(Tag.Name);
+		DeprProperty.PropertyName = Tag.Name;
+		DeprProperty.PropertyTypeName = Tag.Type;
+		DeprProperty.StructTypeName = Tag.StructName;
+		DeprProperty.InnerTypeName = Tag.InnerType;
+		DeprProperty.MapValueTypeName = Tag.ValueType;
+
+		return DeprProperty;
+	}
+
+	//------------------------
+	FDeprecationProperty::Variant& MakeVariant(FDeprecationProperty& Property, bool bIsKey)
+	{
+		return bIsKey ? Property.AddKey() : Property.AddValue();
+	}
+
+	//------------------------
+	EDeprecationVariantType GetPackedType(FName TagType)
+	{
+#define PACKED_TYPE(Name, VariantType) if (TagType == Name) { return EDeprecationVariantType::VariantType; }
+
+		PACKED_TYPE(NAME_BoolProperty, Bool);
+
+		PACKED_TYPE(NAME_Int8Property, Int8);
+		PACKED_TYPE(NAME_Int16Property, Int16);
+		PACKED_TYPE(NAME_IntProperty, Int32);
+		PACKED_TYPE(NAME_Int64Property, Int64);
+
+		PACKED_TYPE(NAME_ByteProperty, UInt8);
+		PACKED_TYPE(NAME_UInt16Property, UInt16);
+		PACKED_TYPE(NAME_UInt32Property, UInt32);
+		PACKED_TYPE(NAME_UInt64Property, UInt64);
+
+		PACKED_TYPE(NAME_FloatProperty, Float);
+		PACKED_TYPE(NAME_DoubleProperty, Double);
+
+#undef PACKED_TYPE
+
+		return EDeprecationVariantType::None;
+	}
+
+	//------------------------
+	bool ReadBoolValue(const FDeprecationPropertyTag& Tag, FStructuredArchive::FStream& ValueStream)
+	{
+		// Properties keep their value in the tag, elements of containers (no size of their own) are serialized as a byte.
+		if (Tag.Size != INDEX_NONE)
+		{
+			return Tag.BoolVal != 0;
+		}
+
+		uint8 Value;
+		ValueStream << Value;
+		return Value != 0;
+	}
+
+	//------------------------
+	FDeprecationPropertyTag MakeTag(const FProperty* Property, int32 ArrayIndex)
+	{
+		FDeprecationPropertyTag Tag;
+		Tag.Name = Property->GetFName();
+		Tag.Type = Property->GetID();
+		Tag.ArrayIndex = ArrayIndex;
+
+		// Read from memory, values have no serialized size.
+		Tag.Size = 0;
+
+		if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+		{
+			Tag.StructName = StructProperty->Struct->GetFName();
+		}
+		else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			Tag.InnerType = ArrayProperty->Inner->GetID();
+		}
+		else if (const FSetProperty* SetProperty = CastField<FSetProperty>(Property))
+		{
+			Tag.InnerType = SetProperty->ElementProp->GetID();
+		}
+		else if (const FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+		{
+			Tag.InnerType = MapProperty->KeyProp->GetID();
+			Tag.ValueType = MapProperty->ValueProp->GetID();
+		}
+
+		return Tag;
+	}
+
+	//------------------------
+	struct FUnversionedProperty
+	{
+		FProperty* Property;
+		int32 ArrayIndex;
+	};
+
+	//------------------------
+	bool LoadUnversionedHeader(FArchive& Archive, const UStruct* Struct, TArray<FUnversionedProperty>& OutProperties)
+	{
+		// Same layout as the engine: fragments of 16 bits (7 bits of properties to skip, a flag if some of the values
+		// are zero, a flag for the last fragment, 7 bits of saved values), then a mask of the values which are zero.
+		struct FFragment
+		{
+			uint8 SkipNum;
+			uint8 ValueNum;
+			bool bHasAnyZeroes;
+		};
+
+		TArray<FFragment, TInlineAllocator<8>> Fragments;
+		int32 NumZeroMaskBits = 0;
+
+		bool bIsLastFragment = false;
+		while (!bIsLastFragment && !Archive.IsError())
+		{
+			uint16 PackedFragment;
+			Archive << PackedFragment;
+
+			FFragment& Fragment = Fragments.AddDefaulted_GetRef();
+			Fragment.SkipNum = (uint8)(PackedFragment & 0x007f);
+			Fragment.bHasAnyZeroes = (PackedFragment & 0x0080) != 0;
+			Fragment.ValueNum = (uint8)(PackedFragment >> 9);
+			bIsLastFragment = (PackedFragment & 0x0100) != 0;
+
+			if (Fragment.bHasAnyZeroes)
+			{
+				NumZeroMaskBits += Fragment.ValueNum;
+			}
+		}
+
+		// Zero values are not serialized, the engine zeroes them in the object which is all the scope reads.
+		if (NumZeroMaskBits > 0)
+		{
+			const int64 ZeroMaskSize = NumZeroMaskBits <= 8 ? sizeof(uint8)
+				: NumZeroMaskBits <= 16 ? sizeof(uint16)
+				: FMath::DivideAndRoundUp(NumZeroMaskBits, 32) * (int64)sizeof(uint32);
+
+			Archive.Seek(Archive.Tell() + ZeroMaskSize);
+		}
+
+		// The schema has a slot per element of each property, in link order.
+		FProperty* Property = Struct->PropertyLink;
+		int32 ArrayIndex = 0;
+
+		auto NextSlot = [&Property, &ArrayIndex]()
+		{
+			if (++ArrayIndex >= Property->ArrayDim)
+			{
+				Property = Property->PropertyLinkNext;
+				ArrayIndex = 0;
+			}
+		};
+
+		for (const FFragment& Fragment : Fragments)
+		{
+			for (int32 Index = 0; Index < Fragment.SkipNum + Fragment.ValueNum; ++Index)
+			{
+				if (!Property)
+				{
+					return false;
+				}
+
+				if (Index >= Fragment.SkipNum)
+				{
+					OutProperties.Add({ Property, ArrayIndex });
+				}
+
+				NextSlot();
+			}
+		}
+
+		return !Archive.IsError();
+	}
+
+	//------------------------
+	EDeprecationVariantType GetPackedStructType(FName StructName)
+	{
+		// Structures whose serialized layout is their memory layout.
+#define PACKED_STRUCT(VariantType) { static const FName Name(TEXT(#VariantType)); if (StructName == Name) { return EDeprecationVariantType::VariantType; } }
+
+		PACKED_STRUCT(Vector2D);
+		PACKED_STRUCT(IntRect);
+		PACKED_STRUCT(IntPoint);
+		PACKED_STRUCT(Vector4);
+		PACKED_STRUCT(Vector);
+		PACKED_STRUCT(Rotator);
+		PACKED_STRUCT(Color);
+		PACKED_STRUCT(Plane);
+		PACKED_STRUCT(Matrix);
+		PACKED_STRUCT(LinearColor);
+		PACKED_STRUCT(Quat);
+		PACKED_STRUCT(Sphere);
+		PACKED_STRUCT(BoxSphereBounds);
+
+#undef PACKED_STRUCT
+
+		return EDeprecationVariantType::None;
+	}
+
+	//------------------------
+	int32 GetPackedComponentSize(EDeprecationVariantType Type)
+	{
+		switch (Type)
+		{
+		case EDeprecationVariantType::Bool:
+		case EDeprecationVariantType::Int8:
+		case EDeprecationVariantType::UInt8:
+			return 1;
+
+		case EDeprecationVariantType::Int16:
+		case EDeprecationVariantType::UInt16:
+			return 2;
+
+		case EDeprecationVariantType::Int64:
+		case EDeprecationVariantType::UInt64:
+		case EDeprecationVariantType::Double:
+			return 8;
+
+			// Packed structures are made of 32 bits components, colors being serialized as a single integer.
+		default:
+			return 4;
+		}
+	}
+
+	//------------------------
+	template <typename T, T (*Swap)(T)>
+	void SwapComponents(uint8* Data, int64 NumBytes)
+	{
+		T* Components = (T*)Data;
+		const int64 NumComponents = NumBytes / sizeof(T);
+
+		for (int64 Index = 0; Index < NumComponents; ++Index)
+		{
+			Components[Index] = Swap(Components[Index]);
+		}
+	}
+
+	FORCEINLINE uint16 Swap16(uint16 Value) { return BYTESWAP_ORDER16(Value); }
+	FORCEINLINE uint32 Swap32(uint32 Value) { return BYTESWAP_ORDER32(Value); }
+	FORCEINLINE uint64 Swap64(uint64 Value) { return BYTESWAP_ORDER64(Value); }
+
+	//------------------------
+	bool CanReadPackedValues(const FArchive& Archive, int32 Count)
+	{
+		// Only binary archives store the elements contiguously, and an empty container has no element to enter.
+		return Count > 0 && !Archive.IsTextFormat();
+	}
+
+	//------------------------
+	void ReadPackedValues(EDeprecationVariantType Type, FArchive& Archive, uint8* PackedValues, int32 Count)
+	{
+		// Packed values are stored contiguously in the archive, with their memory layout, so they are read at once.
+		const int64 NumBytes = (int64)Count * FDeprecationProperty::GetPackedSize(Type);
+		Archive.Serialize(PackedValues, NumBytes);
+
+		// Booleans are serialized as bytes, any value but 0 and 1 would not be a valid bool.
+		if (Type == EDeprecationVariantType::Bool)
+		{
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				PackedValues[Index] = PackedValues[Index] != 0 ? 1 : 0;
+			}
+			return;
+		}
+
+		if (!Archive.IsByteSwapping())
+		{
+			return;
+		}
+
+		switch (GetPackedComponentSize(Type))
+		{
+		case 2: SwapComponents<uint16, &Swap16>(PackedValues, NumBytes); break;
+		case 4: SwapComponents<uint32, &Swap32>(PackedValues, NumBytes); break;
+		case 8: SwapComponents<uint64, &Swap64>(PackedValues, NumBytes); break;
+		default: break;
+		}
+	}
+
+	//------------------------
+	void VisitPackedRuns(EDeprecationVariantType Type, FArchive& Archive, int32 Count, IDeprecationPropertyVisitor& Visitor)
+	{
+		// Read in runs through a fixed buffer, whatever the number of values.
+		alignas(16) uint8 Buffer[4096];
+		const int32 RunSize = sizeof(Buffer) / FDeprecationProperty::GetPackedSize(Type);
+
+		for (int32 First = 0; First < Count; First += RunSize)
+		{
+			const int32 Num = FMath::Min(RunSize, Count - First);
+			ReadPackedValues(Type, Archive, Buffer, Num);
+			Visitor.VisitPackedValues(Type, Buffer, Num);
+		}
+	}
+
+	//------------------------
+	FDeprecationStructDecoders::FDecoder FindStructDecoder(const FDeprecationPropertyTag& Tag)
+	{
+		// Looked up once per tag, not once per value: the decoders are shared behind a lock.
+		FDeprecationStructDecoders::FDecoder Decoder;
+		if (Tag.Type == NAME_StructProperty)
+		{
+			FDeprecationStructDecoders::Get().Find(Tag.StructName, Decoder);
+		}
+		return Decoder;
+	}
+
+	//------------------------
+	bool IsSameType(const FDeprecationTagIndex::FEntry& Entry, const FProperty* Property)
+	{
+		if (Entry.Type != Property->GetID())
+		{
+			return false;
+		}
+
+		if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+		{
+			return Entry.StructName == StructProperty->Struct->GetFName();
+		}
+		if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			return Entry.InnerType == ArrayProperty->Inner->GetID();
+		}
+		if (const FSetProperty* SetProperty = CastField<FSetProperty>(Property))
+		{
+			return Entry.InnerType == SetProperty->ElementProp->GetID();
+		}
+		if (const FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+		{
+			return Entry.InnerType == MapProperty->KeyProp->GetID() && Entry.ValueType == MapProperty->ValueProp->GetID();
+		}
+
+		return true;
+	}
+
+	//------------------------
+	void ConvertNumericValue(EDeprecationVariantType Type, FArchive& Archive, const FNumericProperty* Property, void* Value)
+	{
+		switch (Type)
+		{
+#define NUMERIC_TYPE(VariantType, CppType, IntType) \
+		case EDeprecationVariantType::VariantType: \
+		{ \
+			CppType SourceValue; \
+			Archive << SourceValue; \
+			if (Property->IsFloatingPoint()) { Property->SetFloatingPointPropertyValue(Value, (double)SourceValue); } \
+			else { Property->SetIntPropertyValue(Value, (IntType)SourceValue); } \
+			break; \
+		}
+
+			NUMERIC_TYPE(Int8, int8, int64);
+			NUMERIC_TYPE(Int16, int16, int64);
+			NUMERIC_TYPE(Int32, int32, int64);
+			NUMERIC_TYPE(Int64, int64, int64);
+
+			NUMERIC_TYPE(UInt8, uint8, uint64);
+			NUMERIC_TYPE(UInt16, uint16, uint64);
+			NUMERIC_TYPE(UInt32, uint32, uint64);
+			NUMERIC_TYPE(UInt64, uint64, uint64);
+
+			NUMERIC_TYPE(Float, float, int64);
+			NUMERIC_TYPE(Double, double, int64);
+
+#undef NUMERIC_TYPE
+
+		default: checkNoEntry(); break;
+		}
+	}
+
+	/**
+	 * Receives the values of FDeprecationScope::DecodeValue into the property tree of the scope.
+	 */
+	class FTreeValueSink
+	{
+	public:
+		FTreeValueSink(FDeprecationPropertyTree& InTree, FDeprecationClassCounters& InCounters,
+			FLinkerLoad* InLinker, const FDeprecationLinkerTables* InLinkerTables, FDeprecationProperty::Map& InTargetMap)
+			: Tree(InTree)
+			, Counters(InCounters)
+			, Linker(InLinker)
+			, LinkerTables(InLinkerTables)
+			, TargetMap(&InTargetMap)
+			, TargetProperty(nullptr)
+			, bIsKey(false)
+		{ }
+
+		bool BeginProperty(FDeprecationPropertyTag& Tag)
+		{
+			TargetProperty = &MakeProperty(*TargetMap, Tag);
+			bIsKey = false;
+
+			++Counters.NumPropertiesDecoded;
+			INC_DWORD_STAT(STAT_Deprecation_NumPropertiesDecoded);
+			return true;
+		}
+
+		void EndProperty(const FDeprecationPropertyTag& Tag) { }
+
+		FDeprecationProperty& GetTargetProperty() const
+		{
+			return *TargetProperty;
+		}
+
+		void DecodeNativeStruct(const FDeprecationStructDecoders::FDecoder& Decoder, FArchive& Archive)
+		{
+			Decoder.Decode(Archive, MakeVariant(*TargetProperty, bIsKey));
+		}
+
+		void BeginStruct(const FDeprecationPropertyTag& Tag)
+		{
+			FDeprecationProperty::Variant& Variant = MakeVariant(*TargetProperty, bIsKey);
+
+			// Nested maps are owned by the tree, variants only reference them.
+			Variant.SetProperties(Tree.NewMap());
+
+			++Counters.NumNestedMaps;
+			INC_DWORD_STAT(STAT_Deprecation_NumNestedMaps);
+
+			Frames.Push({ TargetMap, TargetProperty, bIsKey });
+			TargetMap = Variant.GetProperties();
+		}
+
+		void EndStruct()
+		{
+			const FFrame Frame = Frames.Pop(false);
+			TargetMap = Frame.TargetMap;
+			TargetProperty = Frame.TargetProperty;
+			bIsKey = Frame.bIsKey;
+		}
+
+		void BeginArray(const FDeprecationPropertyTag& Tag, int32 Num) { }
+
+		void SetArrayStructName(FName StructName)
+		{
+			if (!bIsKey)
+			{
+				TargetProperty->StructTypeName = StructName;
+			}
+		}
+
+		void EndArray() { }
+		void BeginSet(const FDeprecationPropertyTag& Tag, int32 Num) { }
+		void EndSet() { }
+		void BeginMap(const FDeprecationPropertyTag& Tag, int32 Num) { }
+		void BeginMapKey() { bIsKey = true; }
+		void BeginMapValue() { bIsKey = false; }
+		void EndMap() { }
+
+		bool ReadPacked(EDeprecationVariantType Type, FArchive& Archive, int32 Num)
+		{
+			// Keys are always stored one variant each.
+			if (bIsKey)
+			{
+				return false;
+			}
+
+			ReadPackedValues(Type, Archive, TargetProperty->AddPackedValues(Type, Num), Num);
+			return true;
+		}
+
+		void VisitObject(FPackageIndex PackageIndex)
+		{
+			FDeprecationProperty::Variant& Variant = MakeVariant(*TargetProperty, bIsKey);
+
+			if (Linker)
+			{
+				if (PackageIndex.IsImport())
+				{
+					Variant.Set(Linker->Imp(PackageIndex));
+
+					// Recorded with the full path of the object, imports are resolved together before the handler runs.
+					Tree.AddImport(Variant.GetObjectImport(), FSoftObjectPath(Linker->GetImportPathName(PackageIndex)));
+				}
+				else if (PackageIndex.IsExport())
+				{
+					Variant.Set(Linker->Exp(PackageIndex).Object);
+				}
+				else
+				{
+					Variant.Set((UObject*)nullptr);
+				}
+			}
+			else if (LinkerTables)
+			{
+				// Decoding a snapshot, the same objects as the linker from its copied tables.
+				if (PackageIndex.IsImport() && LinkerTables->Imports.IsValidIndex(PackageIndex.ToImport()))
+				{
+					Variant.Set(LinkerTables->Imports[PackageIndex.ToImport()]);
+					Tree.AddImport(Variant.GetObjectImport(), FSoftObjectPath(LinkerTables->ImportPaths[PackageIndex.ToImport()]));
+				}
+				else if (PackageIndex.IsExport() && LinkerTables->Exports.IsValidIndex(PackageIndex.ToExport()))
+				{
+					Variant.Set(LinkerTables->Exports[PackageIndex.ToExport()]);
+				}
+				else
+				{
+					Variant.Set((UObject*)nullptr);
+				}
+			}
+		}
+
+		void VisitSoftObjectPath(const FSoftObjectPath& Path)
+		{
+			// Kept as a string, resolving it is up to the handler.
+			MakeVariant(*TargetProperty, bIsKey).SetSoftObjectPath(Path.ToString());
+		}
+
+		void VisitString(const FString& Value)
+		{
+			// Copied in the tree, strings must not grow the name table.
+			MakeVariant(*TargetProperty, bIsKey).SetString(Value);
+		}
+
+		template <typename T>
+		void VisitValue(const T& Value)
+		{
+			MakeVariant(*TargetProperty, bIsKey).Set(Value);
+		}
+
+		void SkipValue()
+		{
+			// Types the map does not decode still take their place among the values.
+			MakeVariant(*TargetProperty, bIsKey);
+		}
+
+	private:
+		struct FFrame
+		{
+			FDeprecationProperty::Map* TargetMap;
+			FDeprecationProperty* TargetProperty;
+			bool bIsKey;
+		};
+
+		FDeprecationPropertyTree& Tree;
+		FDeprecationClassCounters& Counters;
+		FLinkerLoad* Linker;
+		const FDeprecationLinkerTables* LinkerTables;
+
+		FDeprecationProperty::Map* TargetMap;
+		FDeprecationProperty* TargetProperty;
+		bool bIsKey;
+		TArray<FFrame, TInlineAllocator<8>> Frames;
+	};
+
+	/**
+	 * Forwards the values of FDeprecationScope::DecodeValue to a property visitor.
+	 */
+	class FVisitorValueSink
+	{
+	public:
+		FVisitorValueSink(IDeprecationPropertyVisitor& InVisitor, FLinkerLoad* InLinker, const FDeprecationLinkerTables* InLinkerTables)
+			: Visitor(InVisitor)
+			, Linker(InLinker)
+			, LinkerTables(InLinkerTables)
+		{ }
+
+		bool BeginProperty(FDeprecationPropertyTag& Tag)
+		{
+			return Visitor.BeginProperty(Tag.Name, Tag.Type);
+		}
+
+		void EndProperty(const FDeprecationPropertyTag& Tag)
+		{
+			Visitor.EndProperty(Tag.Name);
+		}
+
+		void DecodeNativeStruct(const FDeprecationStructDecoders::FDecoder& Decoder, FArchive& Archive)
+		{
+			FDeprecationProperty::Variant Value;
+			Decoder.Decode(Archive, Value);
+			Visitor.VisitValue(Value);
+		}
+
+		void BeginStruct(const FDeprecationPropertyTag& Tag) { Visitor.BeginStruct(Tag.StructName); }
+		void EndStruct() { Visitor.EndStruct(); }
+		void BeginArray(const FDeprecationPropertyTag& Tag, int32 Num) { Visitor.BeginArray(Tag.InnerType, Num); }
+		void SetArrayStructName(FName StructName) { }
+		void EndArray() { Visitor.EndArray(); }
+		void BeginSet(const FDeprecationPropertyTag& Tag, int32 Num) { Visitor.BeginSet(Tag.InnerType, Num); }
+		void EndSet() { Visitor.EndSet(); }
+		void BeginMap(const FDeprecationPropertyTag& Tag, int32 Num) { Visitor.BeginMap(Tag.InnerType, Tag.ValueType, Num); }
+		void BeginMapKey() { }
+		void BeginMapValue() { }
+		void EndMap() { Visitor.EndMap(); }
+
+		bool ReadPacked(EDeprecationVariantType Type, FArchive& Archive, int32 Num)
+		{
+			VisitPackedRuns(Type, Archive, Num, Visitor);
+			return true;
+		}
+
+		void VisitObject(FPackageIndex PackageIndex)
+		{
+			if (Linker && PackageIndex.IsImport())
+			{
+				Visitor.VisitObject(&Linker->Imp(PackageIndex), nullptr);
+			}
+			else if (Linker && PackageIndex.IsExport())
+			{
+				Visitor.VisitObject(nullptr, Linker->Exp(PackageIndex).Object);
+			}
+			else if (LinkerTables && PackageIndex.IsImport() && LinkerTables->Imports.IsValidIndex(PackageIndex.ToImport()))
+			{
+				Visitor.VisitObject(&LinkerTables->Imports[PackageIndex.ToImport()], nullptr);
+			}
+			else if (LinkerTables && PackageIndex.IsExport() && LinkerTables->Exports.IsValidIndex(PackageIndex.ToExport()))
+			{
+				Visitor.VisitObject(nullptr, LinkerTables->Exports[PackageIndex.ToExport()]);
+			}
+			else
+			{
+				Visitor.VisitObject(nullptr, nullptr);
+			}
+		}
+
+		void VisitSoftObjectPath(const FSoftObjectPath& Path)
+		{
+			Visitor.VisitSoftObjectPath(Path.ToString());
+		}
+
+		void VisitString(const FString& Value)
+		{
+			Visitor.VisitString(Value);
+		}
+
+		template <typename T>
+		void VisitValue(const T& Value)
+		{
+			FDeprecationProperty::Variant Variant;
+			Variant.Set(Value);
+			Visitor.VisitValue(Variant);
+		}
+
+		// Types the property map does not decode are skipped.
+		void SkipValue() { }
+
+	private:
+		IDeprecationPropertyVisitor& Visitor;
+		FLinkerLoad* Linker;
+		const FDeprecationLinkerTables* LinkerTables;
+	};
+}
+
+//------------------------
+FDeprecationScope::FDeprecationScope(UObject* Object,
+	FStructuredArchive::FRecord& Record, DeprecationHandler Handler, FName VersionPropertyName)
+	: FDeprecationScope(Object, Record, Handler, nullptr, VersionPropertyName)
+{
+}
+
+//------------------------
+FDeprecationScope::FDeprecationScope(UObject* Object,
+	FStructuredArchive::FRecord& Record, LazyDeprecationHandler LazyHandler, FName VersionPropertyName)
+	: FDeprecationScope(Object, Record, nullptr, LazyHandler, VersionPropertyName)
+{
+}
+
+//------------------------
+FDeprecationScope::FDeprecationScope(UObject* Object,
+	FStructuredArchive::FRecord& Record, FName VersionPropertyName)
+	: FDeprecationScope(Object, Record, nullptr, nullptr, VersionPropertyName)
+{
+}
+
+//------------------------
+FDeprecationScope::FDeprecationScope(UObject* Object,
+	FStructuredArchive::FRecord& Record, DeprecationHandler Handler, const FString& VersionPropertyName)
+	: FDeprecationScope(Object, Record, Handler, nullptr, FName(*VersionPropertyName))
+{
+}
+
+//------------------------
+FDeprecationScope::FDeprecationScope(UObject* Object,
+	FStructuredArchive::FRecord& Record, DeprecationHandler Handler, const TCHAR* VersionPropertyName)
+	: FDeprecationScope(Object, Record, Handler, nullptr, FName(VersionPropertyName))
+{
+}
+
+//------------------------
+FDeprecationScope::FDeprecationScope(UObject* Object,
+	FStructuredArchive::FRecord& Record, LazyDeprecationHandler LazyHandler, const FString& VersionPropertyName)
+	: FDeprecationScope(Object, Record, nullptr, LazyHandler, FName(*VersionPropertyName))
+{
+}
+
+//------------------------
+FDeprecationScope::FDeprecationScope(UObject* Object,
+	FStructuredArchive::FRecord& Record, LazyDeprecationHandler LazyHandler, const TCHAR* VersionPropertyName)
+	: FDeprecationScope(Object, Record, nullptr, LazyHandler, FName(VersionPropertyName))
+{
+}
+
+//------------------------
+FDeprecationScope::FDeprecationScope(UObject* Object, FStructuredArchive::FRecord& Record,
+	DeprecationHandler Handler, LazyDeprecationHandler LazyHandler, FName VersionPropertyName)
+	: Object(Object)
+	, Record(&Record)
+	, Handler(Handler)
+	, LazyHandler(LazyHandler)
+	, ObjectClass(nullptr)
+	, VersionProperty(nullptr)
+	, VersionPropertyName(VersionPropertyName)
+	, PreSerializePosition(Record.GetUnderlyingArchive().Tell())
+	, PostSerializePosition(0)
+	, NumResolvedImports(0)
+	, NumDecodedBytes(0)
+	, LinkerTables(nullptr)
+	, CurrentStep(nullptr)
+	, bIsLoading(Record.GetUnderlyingArchive().IsLoading())
+	, bIsUnversioned(Record.GetUnderlyingArchive().GetArchiveState().UseUnversionedPropertySerialization())
+	, bIsHandlingDeprecation(false)
+	, bAssetHasDeprecationProperty(false)
+	, bHasExceededBudget(false)
+	, bIsSavingPendingUpgrade(false)
+	, CodeVersion(0)
+{
+	if (this->VersionPropertyName.IsNone())
+	{
+		this->VersionPropertyName = FDeprecationClassCache::GetDefaultVersionPropertyName();
+	}
+
+	check(Object);
+	check(this->Record);
+	
+	ObjectClass = Object->GetClass();
+	ClassInfo = FDeprecationClassCache::Get().FindOrAdd(ObjectClass, this->VersionPropertyName);
+	VersionProperty = ClassInfo->VersionProperty;
+	CodeVersion = ClassInfo->CodeVersion;
+
+	if (!VersionProperty)
+	{
+		return;
+	}
+
+	FArchive& UnderlyingArchive = Record.GetUnderlyingArchive();
+
+	if (!bIsLoading)
+	{
+		// An object saved before its queued upgrade has run still holds the data of its asset, it must not be recorded at the code version.
+		uint64 SavedVersion = CodeVersion;
+		if (UnderlyingArchive.IsObjectReferenceCollector())
+		{
+			// Reference collectors (such as the tagging pass of packages) write nothing that is kept, they never wait for the upgrade
+			// but still record the version the object is about to be saved at.
+			FDeprecationPendingUpgrades::Get().FindAssetVersion(Object, SavedVersion);
+		}
+		else if (FinishPendingUpgradeForSave(Object, SavedVersion))
+		{
+			UE_LOG(LogClass, Warning, TEXT("Object '%s' is saved while its upgrade is pending, it is kept at version %llu: archive '%s'"),
+				*Object->GetName(), SavedVersion, *UnderlyingArchive.GetArchiveName());
+
+			// Restored by the destructor, the property has been set to the code version when the upgrade was queued.
+			*VersionProperty->ContainerPtrToValuePtr<uint64>(Object) = SavedVersion;
+			bIsSavingPendingUpgrade = true;
+		}
+
+		// The lowest version saved for the class is recorded in the custom versions of the archive, which only end up in the summary of packages.
+		// A package holds a single version per class for all its objects, loads only trust it when it is the code version (see below).
+		// Set explicitly, the registered custom version is not the one of the class (see FDeprecationClassCache::RegisterCustomVersion).
+		const FCustomVersion* SavedCustomVersion = UnderlyingArchive.GetCustomVersions().GetVersion(ClassInfo->CustomVersionKey);
+		if (!SavedCustomVersion || (uint64)SavedCustomVersion->Version > SavedVersion)
+		{
+			UnderlyingArchive.SetCustomVersion(ClassInfo->CustomVersionKey, (int32)SavedVersion, ClassInfo->CustomVersionFriendlyName);
+		}
+
+		// Other archives (save games, duplication, proxies, ...) only keep the stream, which must hold the version property.
+		const FLinker* Linker = UnderlyingArchive.GetLinker();
+		const bool bRecordsSummary = Linker && Linker->GetType() == ELinkerType::Save;
+
+		if (!bRecordsSummary && !UnderlyingArchive.IsObjectReferenceCollector())
+		{
+			WriteVersionProperty(UnderlyingArchive);
+		}
+		return;
+	}
+
+	// Fast path: the package summary holds the lowest version its objects of the class have been saved at. When it is the code version,
+	// every one of them is current and the probe is skipped, otherwise each object is probed for its own version.
+	// Other archives have no summary, their custom versions default to the registered ones.
+	if (UnderlyingArchive.GetLinker())
+	{
+		const FCustomVersion* AssetCustomVersion = UnderlyingArchive.GetCustomVersions().GetVersion(ClassInfo->CustomVersionKey);
+		if (AssetCustomVersion && (uint64)AssetCustomVersion->Version == CodeVersion)
+		{
+			// Saved at the code version, the version property differs from its default and is in the stream.
+			bAssetHasDeprecationProperty = true;
+
+			// Tags will only be read by the destructor, if the object turns out to be outdated anyway.
+			TagIndex.Suspend(PreSerializePosition);
+			return;
+		}
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_Probe);
+	SCOPE_CYCLE_COUNTER(STAT_Deprecation_Probe);
+
+	// Looking for the deprecation property in the asset (if present).
+	FStructuredArchive::FSlot Slot = Record.EnterField(SA_FIELD_NAME(TEXT("Properties")));
+	FStructuredArchive::FStream Stream = Slot.EnterStream();
+
+	// Every tag read here is kept, so the destructor never parses it twice.
+	bAssetHasDeprecationProperty = GenerateTagIndex(Stream, this->VersionPropertyName);
+
+	// We don't want to disturb the serializer :)
+	Record.GetUnderlyingArchive().Seek(PreSerializePosition);
+}
+
+//------------------------
+FDeprecationScope::FDeprecationScope(UObject* Object, FDeprecationPendingUpgrade& Upgrade)
+	: Object(Object)
+	, Record(nullptr)
+	, Handler(nullptr)
+	, LazyHandler(nullptr)
+	, ObjectClass(Object->GetClass())
+	, VersionProperty(nullptr)
+	, PreSerializePosition(0)
+	, PostSerializePosition(0)
+	, TagIndex(MoveTemp(Upgrade.TagIndex))
+	, Tree(MoveTemp(Upgrade.Tree))
+	, NumResolvedImports(Tree.GetImports().Num())
+	, NumDecodedBytes(0)
+	, LinkerTables(nullptr)
+	, CurrentStep(nullptr)
+	, bIsLoading(true)
+	, bIsUnversioned(false)
+	, bIsHandlingDeprecation(true)
+	, bAssetHasDeprecationProperty(false)
+	, bHasExceededBudget(false)
+	, bIsSavingPendingUpgrade(false)
+	, CodeVersion(Upgrade.CodeVersion)
+{
+	// Every property has been decoded before the upgrade was deferred, the scope never reads an archive.
+}
+
+//------------------------
+FDeprecationScope::FDeprecationScope(FDeprecationDecodeTask& Task, FStructuredArchive::FRecord& SnapshotRecord)
+	: Object(nullptr)
+	, Record(&SnapshotRecord)
+	, Handler(nullptr)
+	, LazyHandler(nullptr)
+	, ObjectClass(nullptr)
+	, ClassInfo(Task.ClassInfo)
+	, VersionProperty(nullptr)
+	, PreSerializePosition(0)
+	, PostSerializePosition(0)
+	, TagIndex(MoveTemp(Task.TagIndex))
+	, Tree(MoveTemp(Task.Tree))
+	, NumResolvedImports(0)
+	, NumDecodedBytes(0)
+	, LinkerTables(Task.Snapshot.Tables.Get())
+	, CacheKey(MoveTemp(Task.CacheKey))
+	, CacheTables(Task.Snapshot.Tables)
+	, CurrentStep(nullptr)
+	, bIsLoading(true)
+	, bIsUnversioned(false)
+	, bIsHandlingDeprecation(false)
+	, bAssetHasDeprecationProperty(false)
+	, bHasExceededBudget(false)
+	, bIsSavingPendingUpgrade(false)
+	, CodeVersion(Task.CodeVersion)
+{
+	// Only decodes, the object may be serialized by the loading thread meanwhile and is never touched.
+}
+
+//------------------------
+FDeprecationScope::~FDeprecationScope()
+{
+	if (!VersionProperty)
+	{
+		return;
+	}
+
+	if (!bIsLoading)
+	{
+		if (bIsSavingPendingUpgrade)
+		{
+			*VersionProperty->ContainerPtrToValuePtr<uint64>(Object) = CodeVersion;
+		}
+		return;
+	}
+
+	PostSerializePosition = Record->GetUnderlyingArchive().Tell();
+
+	uint64 AssetVersion;
+
+	if (!CheckDeprecation(AssetVersion))
+	{
+		*VersionProperty->ContainerPtrToValuePtr<uint64>(Object) = CodeVersion;
+
+		++ClassInfo->Counters.NumSkipped;
+		INC_DWORD_STAT(STAT_Deprecation_NumSkipped);
+	}
+	else
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_Upgrade);
+
+		CompleteTagIndex();
+
+		const bool bHasSteps = ClassInfo->Steps.IsValid();
+		const bool bShouldDefer = ShouldDeferHandler();
+
+		// Unversioned properties follow the schema the asset was cooked with, not the one of the class: removed or renamed properties
+		// cannot be decoded. The object is left at its version rather than upgraded without them.
+		if (bIsUnversioned && (Handler || LazyHandler || bHasSteps || ClassInfo->FieldRules.IsValid()))
+		{
+			RefuseUpgrade(AssetVersion, TEXT("its properties are saved unversioned, without the schema they were saved with"));
+			return;
+		}
+
+		// Upgrades are checked against the budget before decoding anything, so handlers never run without the properties they ask for.
+		if (!IsWithinDecodeBudget(GetUpgradeSerializedSize(AssetVersion)))
+		{
+			RefuseUpgrade(AssetVersion, TEXT("it exceeds the decode budget"));
+			return;
+		}
+
+		if (Handler || LazyHandler)
+		{
+			PrepareTreeCache(AssetVersion);
+		}
+
+		*VersionProperty->ContainerPtrToValuePtr<uint64>(Object) = CodeVersion;
+
+		++ClassInfo->Counters.NumUpgraded;
+		INC_DWORD_STAT(STAT_Deprecation_NumUpgraded);
+
+		// Rules write into the object like serialization does, they never need to be deferred.
+		if (ClassInfo->FieldRules.IsValid())
+		{
+			ApplyFieldRules(AssetVersion);
+		}
+
+		if (!Handler && !LazyHandler && !bHasSteps)
+		{
+			Record->GetUnderlyingArchive().Seek(PostSerializePosition);
+
+			if (IsInGameThread())
+			{
+				OnObjectUpgraded().Broadcast(Object, AssetVersion, CodeVersion);
+			}
+			return;
+		}
+
+		if (bShouldDefer)
+		{
+			FDeprecationPendingUpgrade Upgrade;
+			Upgrade.Object = Object;
+			Upgrade.Handler = Handler;
+			Upgrade.LazyHandler = LazyHandler;
+			Upgrade.Steps = ClassInfo->Steps;
+			Upgrade.AssetVersion = AssetVersion;
+			Upgrade.CodeVersion = CodeVersion;
+
+			if (!StartDecodeTask(Upgrade))
+			{
+				// The archive is only valid now, everything the handlers may ask for is decoded before deferring them.
+				ReserveRoot();
+
+				if (Handler || LazyHandler)
+				{
+					GenerateRoot();
+				}
+				else
+				{
+					GenerateStepProperties(*ClassInfo->Steps, AssetVersion);
+				}
+
+				Upgrade.TagIndex = MoveTemp(TagIndex);
+				Upgrade.Tree = MoveTemp(Tree);
+			}
+
+			FDeprecationPendingUpgrades::Get().Add(MoveTemp(Upgrade));
+			Record->GetUnderlyingArchive().Seek(PostSerializePosition);
+			return;
+		}
+
+		ReserveRoot();
+		bIsHandlingDeprecation = true;
+
+		if (bHasSteps)
+		{
+			RunSteps(*ClassInfo->Steps, AssetVersion);
+		}
+
+		if (Handler)
+		{
+			GenerateRoot();
+			ResolveImports();
+
+			TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_Handler);
+			SCOPE_CYCLE_COUNTER(STAT_Deprecation_Handler);
+			(Object->*Handler)(Tree.GetRoot(), AssetVersion, CodeVersion);
+		}
+		else if (LazyHandler)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_Handler);
+			SCOPE_CYCLE_COUNTER(STAT_Deprecation_Handler);
+			(Object->*LazyHandler)(*this, AssetVersion, CodeVersion);
+		}
+
+		bIsHandlingDeprecation = false;
+
+		// A step read a property it did not declare, past the budget: the upgrade has not seen all its data.
+		if (bHasExceededBudget)
+		{
+			--ClassInfo->Counters.NumUpgraded;
+			DEC_DWORD_STAT(STAT_Deprecation_NumUpgraded);
+
+			RefuseUpgrade(AssetVersion, TEXT("a step exceeds the decode budget"));
+			return;
+		}
+
+		Record->GetUnderlyingArchive().Seek(PostSerializePosition);
+
+		if (IsInGameThread())
+		{
+			OnObjectUpgraded().Broadcast(Object, AssetVersion, CodeVersion);
+		}
+	}
+}
+
+//------------------------
+bool FDeprecationScope::GetClassCustomVersion(UClass* Class, FName VersionPropertyName, FGuid& OutKey, int32& OutVersion)
+{
+	if (VersionPropertyName.IsNone())
+	{
+		VersionPropertyName = FDeprecationClassCache::GetDefaultVersionPropertyName();
+	}
+
+	const FDeprecationClassInfoPtr Info = FDeprecationClassCache::Get().FindOrAdd(Class, VersionPropertyName);
+	if (!Info->VersionProperty)
+	{
+		return false;
+	}
+
+	OutKey = Info->CustomVersionKey;
+	OutVersion = (int32)Info->CodeVersion;
+	return true;
+}
+
+//------------------------
+FDeprecationScope::FOnObjectUpgraded& FDeprecationScope::OnObjectUpgraded()
+{
+	static FOnObjectUpgraded Event;
+	return Event;
+}
+
+//------------------------
+bool FDeprecationScope::FinishPendingUpgrade(UObject* Object)
+{
+	// PostLoad may run on the async loading thread, the ticker will run the upgrade then (as it does for queued upgrades).
+	if (!IsInGameThread() || IsInAsyncLoadingThread() || CVarQueueUpgrades.GetValueOnGameThread() != 0)
+	{
+		return false;
+	}
+
+	return FDeprecationPendingUpgrades::Get().Run(Object);
+}
+
+//------------------------
+bool FDeprecationScope::FinishPendingUpgradeForSave(UObject* Object, uint64& OutAssetVersion)
+{
+	FDeprecationPendingUpgrades& PendingUpgrades = FDeprecationPendingUpgrades::Get();
+	if (!PendingUpgrades.FindAssetVersion(Object, OutAssetVersion))
+	{
+		return false;
+	}
+
+	// Handlers only run on the game thread, saves from other threads keep the version of the asset.
+	if (IsInGameThread() && !IsInAsyncLoadingThread())
+	{
+		PendingUpgrades.WaitForDecoding();
+		PendingUpgrades.Run(Object);
+
+		// Upgrades may still be waiting for the packages they reference.
+		if (PendingUpgrades.Contains(Object))
+		{
+			FlushAsyncLoading();
+			PendingUpgrades.Run(Object);
+		}
+	}
+
+	return PendingUpgrades.FindAssetVersion(Object, OutAssetVersion);
+}
+
+//------------------------
+void FDeprecationScope::WriteVersionProperty(FArchive& UnderlyingArchive)
+{
+	// Delta serialization skips the version property when it is equal to the one of the archetype, which it is once upgraded.
+	// Every other property keeps being written as a delta.
+	const UObject* Archetype = Object->GetArchetype();
+	if (!UnderlyingArchive.DoDelta() || UnderlyingArchive.IsTransacting() || UnderlyingArchive.IsTextFormat() || bIsUnversioned
+		|| !Archetype || !Archetype->IsA(VersionProperty->GetOwnerClass()) || !VersionProperty->Identical_InContainer(Object, Archetype))
+	{
+		return;
+	}
+
+	// Tags are read in any order, the one written here is followed by the tags of the object. Loads stop probing on it (see GenerateTagIndex).
+	uint64& Value = *VersionProperty->ContainerPtrToValuePtr<uint64>(Object);
+
+	FDeprecationPropertyTag Tag(UnderlyingArchive, VersionProperty, 0, (uint8*)&Value, nullptr);
+	Tag.Size = sizeof(uint64);
+
+	UnderlyingArchive << Tag;
+	UnderlyingArchive << Value;
+}
+
+//------------------------
+int32 FDeprecationScope::FlushPendingUpgrades()
+{
+	FDeprecationPendingUpgrades& PendingUpgrades = FDeprecationPendingUpgrades::Get();
+	PendingUpgrades.WaitForDecoding();
+
+	int32 NumUpgrades = PendingUpgrades.RunReady();
+
+	// Ready upgrades may still be waiting for the packages they reference.
+	if (PendingUpgrades.HasPendingLoads())
+	{
+		FlushAsyncLoading();
+		NumUpgrades += PendingUpgrades.RunReady();
+	}
+
+	return NumUpgrades;
+}
+
+//------------------------
+bool FDeprecationScope::IsUpgradePending(const UObject* Object)
+{
+	return FDeprecationPendingUpgrades::Get().Contains(Object);
+}
+
+//------------------------
+void FDeprecationScope::LoadObjectAsync(const FSoftObjectPath& Path, TFunction<void(UObject*)> Callback)
+{
+	if (UObject* LoadedObject = Path.ResolveObject())
+	{
+		Callback(LoadedObject);
+		return;
+	}
+
+	LoadPackageAsync(Path.GetLongPackageName(), FLoadPackageAsyncDelegate::CreateLambda(
+		[Path, Callback = MoveTemp(Callback)](const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result)
+	{
+		Callback(Result == EAsyncLoadingResult::Succeeded ? Path.ResolveObject() : nullptr);
+	}));
+}
+
+//------------------------
+bool FDeprecationScope::ShouldDeferHandler()
+{
+	// Handlers may load their dependencies synchronously, which is only allowed on the game thread outside of async loading.
+	return !IsInGameThread() || IsInAsyncLoadingThread() || CVarQueueUpgrades.GetValueOnAnyThread() != 0;
+}
+
+//------------------------
+bool FDeprecationScope::StartDecodeTask(FDeprecationPendingUpgrade& Upgrade)
+{
+	if (CVarQueueUpgrades.GetValueOnAnyThread() == 0 || TagIndex.Num() == 0)
+	{
+		return false;
+	}
+
+	// Only the names and objects of a linker can be read away from it, other archives are decoded right away.
+	FArchive& UnderlyingArchive = Record->GetUnderlyingArchive();
+	FLinkerLoad* Linker = (FLinkerLoad*)UnderlyingArchive.GetLinker();
+	if (!Linker || static_cast<FArchive*>(Linker) != &UnderlyingArchive)
+	{
+		return false;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_Snapshot);
+	SCOPE_CYCLE_COUNTER(STAT_Deprecation_Snapshot);
+
+	int64 FirstOffset = MAX_int64;
+	int64 LastOffset = 0;
+
+	for (const FDeprecationTagIndex::FEntry& Entry : TagIndex.GetEntries())
+	{
+		FirstOffset = FMath::Min(FirstOffset, Entry.ValueOffset);
+		LastOffset = FMath::Max(LastOffset, Entry.ValueOffset + Entry.Size);
+	}
+
+	TSharedRef<FDeprecationDecodeTask, ESPMode::ThreadSafe> Task =
+		MakeShared<FDeprecationDecodeTask, ESPMode::ThreadSafe>(*Linker, FirstOffset, LastOffset - FirstOffset);
+
+	Task->ClassInfo = ClassInfo;
+	Task->TagIndex = MoveTemp(TagIndex);
+	Task->AssetVersion = Upgrade.AssetVersion;
+	Task->CodeVersion = CodeVersion;
+	Task->bDecodeRoot = Handler || LazyHandler;
+	Task->CacheKey = MoveTemp(CacheKey);
+
+	Upgrade.DecodeTask = Task;
+	Upgrade.DecodeResult = Async(EAsyncExecution::TaskGraph, [Task]()
+	{
+		DecodeSnapshot(*Task);
+	});
+
+	return true;
+}
+
+//------------------------
+void FDeprecationScope::DecodeSnapshot(FDeprecationDecodeTask& Task)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_DecodeSnapshot);
+	SCOPE_CYCLE_COUNTER(STAT_Deprecation_DecodeSnapshot);
+
+	FDeprecationSnapshotReader Reader(Task.Snapshot);
+	FStructuredArchiveFromArchive SnapshotArchive(Reader);
+	FStructuredArchive::FRecord SnapshotRecord = SnapshotArchive.GetSlot().EnterRecord();
+
+	FDeprecationScope DecodingScope(Task, SnapshotRecord);
+	DecodingScope.ReserveRoot();
+
+	if (Task.bDecodeRoot)
+	{
+		DecodingScope.GenerateRoot();
+	}
+	else
+	{
+		DecodingScope.GenerateStepProperties(*Task.ClassInfo->Steps, Task.AssetVersion);
+	}
+
+	Task.TagIndex = MoveTemp(DecodingScope.TagIndex);
+	Task.Tree = MoveTemp(DecodingScope.Tree);
+}
+
+//------------------------
+void FDeprecationScope::RunDeferredHandler(FDeprecationPendingUpgrade& Upgrade)
+{
+	UObject* Object = Upgrade.Object.Get();
+	if (!Object)
+	{
+		return;
+	}
+
+	// Packages of the imports have been loaded while the upgrade was pending.
+	Upgrade.Tree.ResolveImports(0, nullptr);
+
+	FDeprecationScope DetachedScope(Object, Upgrade);
+
+	if (Upgrade.Steps.IsValid())
+	{
+		DetachedScope.RunSteps(*Upgrade.Steps, Upgrade.AssetVersion);
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_Handler);
+	SCOPE_CYCLE_COUNTER(STAT_Deprecation_Handler);
+
+	if (Upgrade.Handler)
+	{
+		(Object->*Upgrade.Handler)(DetachedScope.GetRoot(), Upgrade.AssetVersion, Upgrade.CodeVersion);
+	}
+	else if (Upgrade.LazyHandler)
+	{
+		(Object->*Upgrade.LazyHandler)(DetachedScope, Upgrade.AssetVersion, Upgrade.CodeVersion);
+	}
+
+	OnObjectUpgraded().Broadcast(Object, Upgrade.AssetVersion, Upgrade.CodeVersion);
+}
+
+//------------------------
+bool FDeprecationScope::CheckDeprecation(uint64& AssetVersion)
+{
+	AssetVersion = *VersionProperty->ContainerPtrToValuePtr<uint64>(Object);
+
+	if (!bAssetHasDeprecationProperty)
+	{
+		AssetVersion = 0;
+	}
+
+	return CodeVersion > AssetVersion;
+}
+
+//------------------------
+const FDeprecationProperty* FDeprecationScope::FindProperty(FName PropertyName)
+{
+	if (const FDeprecationProperty* Property = Tree.GetRoot().Find(PropertyName))
+	{
+		return Property;
+	}
+
+	const FDeprecationTagIndex::FEntry* Entry = TagIndex.Find(PropertyName);
+	if (!Entry)
+	{
+		return nullptr;
+	}
+
+	if (!ensureMsgf(bIsHandlingDeprecation, TEXT("Property '%s' can only be decoded while the deprecation handler is running."), *PropertyName.ToString()))
+	{
+		return nullptr;
+	}
+
+	ensureMsgf(!CurrentStep || CurrentStep->Properties.Contains(PropertyName),
+		TEXT("Property '%s' is read by the step to version %llu without being declared by it."), *PropertyName.ToString(), CurrentStep ? CurrentStep->Version : 0);
+
+	// Detached scopes (deferred upgrades) have no archive left to decode from.
+	if (!Record)
+	{
+		return nullptr;
+	}
+
+	if (!IsWithinDecodeBudget(Entry->Size))
+	{
+		UE_LOG(LogClass, Warning, TEXT("Property '%s' exceeds the decode budget: object '%s', archive '%s'"),
+			*PropertyName.ToString(), *Object->GetName(), *Record->GetUnderlyingArchive().GetArchiveName());
+
+		bHasExceededBudget = true;
+		return nullptr;
+	}
+
+	const FDeprecationProperty& Property = GenerateProperty(*Entry);
+	ResolveImports();
+
+	return &Property;
+}
+
+//------------------------
+FDeprecationPropertyTree FDeprecationScope::ReleaseTree()
+{
+	if (!ensureMsgf(bIsHandlingDeprecation, TEXT("Property tree can only be released while the deprecation handler is running.")))
+	{
+		return FDeprecationPropertyTree();
+	}
+
+	GenerateRoot();
+	ResolveImports();
+
+	FDeprecationPropertyTree ReleasedTree(MoveTemp(Tree));
+	NumResolvedImports = 0;
+	ReserveRoot();
+
+	return ReleasedTree;
+}
+
+//------------------------
+void FDeprecationScope::Visit(IDeprecationPropertyVisitor& Visitor)
+{
+	if (!ensureMsgf(bIsHandlingDeprecation, TEXT("Properties can only be visited while the deprecation handler is running.")))
+	{
+		return;
+	}
+
+	// Detached scopes (deferred upgrades) have no archive left, only their decoded tree.
+	if (!Record)
+	{
+		Visitor.Visit(Tree.GetRoot());
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_Visit);
+	SCOPE_CYCLE_COUNTER(STAT_Deprecation_Visit);
+
+	for (const FDeprecationTagIndex::FEntry& Entry : TagIndex.GetEntries())
+	{
+		VisitProperty(Entry, Visitor);
+	}
+}
+
+//------------------------
+bool FDeprecationScope::Visit(FName PropertyName, IDeprecationPropertyVisitor& Visitor)
+{
+	if (!ensureMsgf(bIsHandlingDeprecation, TEXT("Property '%s' can only be visited while the deprecation handler is running."), *PropertyName.ToString()))
+	{
+		return false;
+	}
+
+	ensureMsgf(!CurrentStep || CurrentStep->Properties.Contains(PropertyName),
+		TEXT("Property '%s' is read by the step to version %llu without being declared by it."), *PropertyName.ToString(), CurrentStep ? CurrentStep->Version : 0);
+
+	if (!Record)
+	{
+		const FDeprecationProperty* Property = Tree.GetRoot().Find(PropertyName);
+		if (!Property)
+		{
+			return false;
+		}
+
+		Visitor.Visit(*Property);
+		return true;
+	}
+
+	const FDeprecationTagIndex::FEntry* Entry = TagIndex.Find(PropertyName);
+	if (!Entry)
+	{
+		return false;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_Visit);
+	SCOPE_CYCLE_COUNTER(STAT_Deprecation_Visit);
+
+	VisitProperty(*Entry, Visitor);
+	return true;
+}
+
 //------------------------
-namespace
+bool FDeprecationScope::IsWithinDecodeBudget(int64 NumBytes) const
 {
-	//------------------------
-	FDeprecationProperty& MakeProperty(
-		FDeprecationProperty::Map& TargetMap, FDeprecationPropertyTag& Tag)
+	const int32 MaxDecodedBytes = CVarMaxDecodedBytesPerObject.GetValueOnAnyThread();
+	return MaxDecodedBytes <= 0 || NumDecodedBytes + NumBytes <= MaxDecodedBytes;
+}
+
+//------------------------
+int64 FDeprecationScope::GetUpgradeSerializedSize(uint64 AssetVersion) const
+{
+	// Lazy handlers may ask for any property, they are given the budget of the whole root.
+	if (Handler || LazyHandler)
 	{
-		FDeprecationProperty& DeprProperty = TargetMap.Add(Tag.Name);
-		DeprProperty.PropertyName = Tag.Name;
-		DeprProperty.PropertyTypeName = Tag.Type;
-		DeprProperty.StructTypeName = Tag.StructName;
-		DeprProperty.InnerTypeName = Tag.InnerType;
-		DeprProperty.MapValueTypeName = Tag.ValueType;
+		return TagIndex.GetSerializedSize();
+	}
 
-		return DeprProperty;
+	if (!ClassInfo->Steps.IsValid())
+	{
+		return 0;
 	}
 
-	//------------------------
-	FDeprecationProperty::Variant& MakeVariant(FDeprecationProperty& Property, bool bIsKey)
+	// Steps only read the properties they declare, each decoded once whatever the number of steps reading it.
+	TSet<FName> StepProperties;
+	for (const FDeprecationSteps::FStep& Step : ClassInfo->Steps->GetSteps())
 	{
-		return bIsKey ? Property.AddKey() : Property.AddValue();
+		if (Step.Version > AssetVersion && Step.Version <= CodeVersion)
+		{
+			StepProperties.Append(Step.Properties);
+		}
 	}
+
+	int64 SerializedSize = 0;
+	for (FName PropertyName : StepProperties)
+	{
+		if (const FDeprecationTagIndex::FEntry* Entry = TagIndex.Find(PropertyName))
+		{
+			SerializedSize += Entry->Size;
+		}
+	}
+	return SerializedSize;
 }
 
 //------------------------
-FDeprecationScope::FDeprecationScope(UObject* Object,
-	FStructuredArchive::FRecord& Record, DeprecationHandler Handler, FString VersionPropertyName)
-	: Object(Object)
-	, Record(&Record)
-	, Handler(Handler)
-	, ObjectClass(nullptr)
-	, VersionProperty(nullptr)
-	, VersionPropertyName(VersionPropertyName)
-	, PreSerializePosition(Record.GetUnderlyingArchive().Tell())
-	, PostSerializePosition(0)
-	, bIsLoading(Record.GetUnderlyingArchive().IsLoading())
-	, bAssetHasDeprecationProperty(false)
-	, CodeVersion(0)
+void FDeprecationScope::RefuseUpgrade(uint64 AssetVersion, const TCHAR* Reason)
 {
-	static constexpr char* DefaultVersionPropertyName = "DeprecationVersion";
+	UE_LOG(LogClass, Warning, TEXT("Upgrade of '%s' from version %llu is refused because %s, the object is left at its version: archive '%s'"),
+		*Object->GetName(), AssetVersion, Reason, *Record->GetUnderlyingArchive().GetArchiveName());
+
+	++ClassInfo->Counters.NumRefused;
+
+	// Left outdated rather than half upgraded, it is upgraded again the next time it is loaded.
+	*VersionProperty->ContainerPtrToValuePtr<uint64>(Object) = AssetVersion;
+	Record->GetUnderlyingArchive().Seek(PostSerializePosition);
+}
 
-	if (VersionPropertyName.IsEmpty())
+//------------------------
+void FDeprecationScope::PrepareTreeCache(uint64 AssetVersion)
+{
+	if (!FDeprecationTreeCache::IsEnabled())
 	{
-		VersionPropertyName = DefaultVersionPropertyName;
+		return;
 	}
 
-	check(Object);
-	check(this->Record);
-	
-	ObjectClass = Object->GetClass();
-	VersionProperty = CastField<FUInt64Property>(ObjectClass->FindPropertyByName(*VersionPropertyName));
-	ensureAlwaysMsgf(VersionProperty, TEXT("Version property with name '%s' not found."), *VersionPropertyName);
+	FLinkerLoad* Linker = (FLinkerLoad*)Record->GetUnderlyingArchive().GetLinker();
+	if (!Linker)
+	{
+		return;
+	}
 
-	uint64* CodeVersionPtr = VersionProperty->ContainerPtrToValuePtr<uint64>(ObjectClass->GetDefaultObject());
-	CodeVersion = *CodeVersionPtr;
-	ensureAlwaysMsgf(CodeVersion != (uint64)-1, TEXT("Version property with name '%s' can not have MAX value (reserved)."), *VersionPropertyName);
+	CacheKey = FDeprecationTreeCache::MakeKey(*Linker, Object, AssetVersion, CodeVersion);
+	CacheTables = FDeprecationSnapshot::FindOrAddTables(*Linker);
+}
 
-	if (!bIsLoading)
+//------------------------
+void FDeprecationScope::ApplyFieldRules(uint64 AssetVersion)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_FieldRules);
+	SCOPE_CYCLE_COUNTER(STAT_Deprecation_FieldRules);
+
+	const FDeprecationFieldRules& FieldRules = *ClassInfo->FieldRules;
+
+	for (const FDeprecationTagIndex::FEntry& Entry : TagIndex.GetEntries())
+	{
+		const FName NewPath = FieldRules.MapPath(Entry.Name, AssetVersion, CodeVersion);
+		if (NewPath.IsNone())
+		{
+			continue;
+		}
+
+		const TArray<FProperty*, TInlineAllocator<2>>* Target = ClassInfo->FieldRuleTargets.Find(NewPath);
+		if (!Target)
+		{
+			continue;
+		}
+
+		// Going down the structures of the path, to the value of the target property.
+		void* Container = Object;
+		for (int32 Index = 0; Index < Target->Num() - 1; ++Index)
+		{
+			Container = (*Target)[Index]->ContainerPtrToValuePtr<void>(Container);
+		}
+
+		// Every element of a static array has its own entry, and is written to the same element of the target.
+		FProperty* Property = Target->Last();
+		if (Entry.ArrayIndex >= Property->ArrayDim)
+		{
+			continue;
+		}
+
+		if (!ApplyFieldRule(Entry, Property, Property->ContainerPtrToValuePtr<void>(Container, Entry.ArrayIndex)))
+		{
+			UE_LOG(LogClass, Warning, TEXT("Field rule can not convert '%s' (%s) to '%s' (%s): object '%s', archive '%s'"),
+				*Entry.Name.ToString(), *Entry.Type.ToString(), *NewPath.ToString(), *Property->GetID().ToString(),
+				*Object->GetName(), *Record->GetUnderlyingArchive().GetArchiveName());
+		}
+	}
+}
+
+//------------------------
+bool FDeprecationScope::ApplyFieldRule(const FDeprecationTagIndex::FEntry& Entry, FProperty* Property, void* Value)
+{
+	// Booleans are held by their tag.
+	if (Entry.Type == NAME_BoolProperty)
+	{
+		FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property);
+		if (BoolProperty)
+		{
+			BoolProperty->SetPropertyValue(Value, Entry.BoolVal != 0);
+		}
+		return BoolProperty != nullptr;
+	}
+
+	FArchive& UnderlyingArchive = Record->GetUnderlyingArchive();
+	UnderlyingArchive.Seek(Entry.ValueOffset);
+
+	// Same type: the property reads its value exactly as serialization would have.
+	if (IsSameType(Entry, Property))
+	{
+		FStructuredArchiveFromArchive ValueArchive(UnderlyingArchive);
+		Property->SerializeItem(ValueArchive.GetSlot(), Value);
+		return true;
+	}
+
+	// Numeric types, widened (or narrowed) to the type of the property.
+	const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property);
+	const EDeprecationVariantType SourceType = GetPackedType(Entry.Type);
+
+	if (!NumericProperty || NumericProperty->IsEnum() || SourceType == EDeprecationVariantType::None
+		|| Entry.Size != FDeprecationProperty::GetPackedSize(SourceType))
+	{
+		return false;
+	}
+
+	ConvertNumericValue(SourceType, UnderlyingArchive, NumericProperty, Value);
+	return true;
+}
+
+//------------------------
+void FDeprecationScope::RunSteps(const FDeprecationSteps& Steps, uint64 AssetVersion)
+{
+	// Decoded all at once, so their imports are resolved in a single batch.
+	GenerateStepProperties(Steps, AssetVersion);
+
+	for (const FDeprecationSteps::FStep& Step : Steps.GetSteps())
+	{
+		if (Step.Version <= AssetVersion)
+		{
+			continue;
+		}
+		if (Step.Version > CodeVersion)
+		{
+			break;
+		}
+
+		TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_Step);
+		SCOPE_CYCLE_COUNTER(STAT_Deprecation_Step);
+
+		CurrentStep = &Step;
+		(Object->*Step.Handler)(*this);
+		CurrentStep = nullptr;
+	}
+}
+
+//------------------------
+void FDeprecationScope::GenerateStepProperties(const FDeprecationSteps& Steps, uint64 AssetVersion)
+{
+	// Detached scopes have been given their properties when deferred.
+	if (!Record)
 	{
-		// If saving, we have to set the code version to invalid value,
-		// so the system serializes the current value (which should be the default value).
-		*CodeVersionPtr = (uint64)-1;
 		return;
 	}
 
-	// Looking for the deprecation property in the asset (if present).
-	FStructuredArchive::FSlot Slot = Record.EnterField(SA_FIELD_NAME(TEXT("Properties")));
-	FStructuredArchive::FStream Stream = Slot.EnterStream();
+	for (const FDeprecationSteps::FStep& Step : Steps.GetSteps())
+	{
+		if (Step.Version <= AssetVersion || Step.Version > CodeVersion)
+		{
+			continue;
+		}
+
+		for (FName PropertyName : Step.Properties)
+		{
+			const FDeprecationTagIndex::FEntry* Entry = TagIndex.Find(PropertyName);
+			if (Entry && !Tree.GetRoot().Contains(PropertyName))
+			{
+				GenerateProperty(*Entry);
+			}
+		}
+	}
+
+	// Deferred upgrades resolve their imports on the game thread.
+	if (!ShouldDeferHandler())
+	{
+		ResolveImports();
+	}
+}
+
+//------------------------
+bool FDeprecationScope::GenerateTagIndex(FStructuredArchive::FStream& Stream, FName StopPropertyName)
+{
+	FArchive& UnderlyingArchive = Stream.GetUnderlyingArchive();
 
-	FName FNameVersionPropertyName(*VersionPropertyName);
+	if (bIsUnversioned)
+	{
+		return GenerateUnversionedTagIndex(UnderlyingArchive, StopPropertyName);
+	}
 
 	while (true)
 	{
@@ -90,75 +1692,186 @@ FDeprecationScope::FDeprecationScope(UObject* Object,
 		}
 		if (!Tag.Name.IsValid())
 		{
-			UE_LOG(LogClass, Warning, TEXT("Invalid tag name: struct '%s', archive '%s'"), *Object->GetName(), *Record.GetUnderlyingArchive().GetArchiveName());
+			UE_LOG(LogClass, Warning, TEXT("Invalid tag name: struct '%s', archive '%s'"), *Object->GetName(), *UnderlyingArchive.GetArchiveName());
 			break;
 		}
-		if (Tag.Name == FNameVersionPropertyName)
+
+		const int64 ValueOffset = UnderlyingArchive.Tell();
+		TagIndex.Add(Tag, ValueOffset);
+
+		if (Tag.Name == StopPropertyName)
 		{
-			bAssetHasDeprecationProperty = true;
-			break;
+			TagIndex.Suspend(ValueOffset + Tag.Size);
+			return true;
 		}
 
-		Record.GetUnderlyingArchive().Seek(Record.GetUnderlyingArchive().Tell()
-			+ Tag.Size);
+		UnderlyingArchive.Seek(ValueOffset + Tag.Size);
 	}
 
-	// We don't want to disturb the serializer :)
-	Record.GetUnderlyingArchive().Seek(PreSerializePosition);
+	TagIndex.Complete();
+	return false;
 }
 
 //------------------------
-FDeprecationScope::~FDeprecationScope()
+bool FDeprecationScope::GenerateUnversionedTagIndex(FArchive& UnderlyingArchive, FName StopPropertyName)
 {
-	if (!bIsLoading)
+	// Reading the header is cheap enough to never stop at the property looked for.
+	TArray<FUnversionedProperty> Properties;
+	if (!LoadUnversionedHeader(UnderlyingArchive, ObjectClass, Properties))
+	{
+		UE_LOG(LogClass, Warning, TEXT("Unversioned properties do not match the class: object '%s', archive '%s'"),
+			*Object->GetName(), *UnderlyingArchive.GetArchiveName());
+	}
+
+	bool bHasStopProperty = false;
+
+	for (const FUnversionedProperty& Property : Properties)
+	{
+		TagIndex.Add(MakeTag(Property.Property, Property.ArrayIndex), INDEX_NONE);
+		bHasStopProperty = bHasStopProperty || Property.Property->GetFName() == StopPropertyName;
+	}
+
+	TagIndex.Complete();
+	return bHasStopProperty;
+}
+
+//------------------------
+void FDeprecationScope::CompleteTagIndex()
+{
+	if (TagIndex.IsComplete())
 	{
-		// Resetting the code version (for the same reason than in constructor).
-		uint64* CodeVersionPtr = VersionProperty->ContainerPtrToValuePtr<uint64>(ObjectClass->GetDefaultObject());
-		*CodeVersionPtr = CodeVersion;
 		return;
 	}
 
-	PostSerializePosition = Record->GetUnderlyingArchive().Tell();
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_CompleteTagIndex);
+	SCOPE_CYCLE_COUNTER(STAT_Deprecation_CompleteTagIndex);
 
-	uint64 AssetVersion;
+	FArchive& UnderlyingArchive = Record->GetUnderlyingArchive();
+	UnderlyingArchive.Seek(TagIndex.GetResumeOffset());
+
+	FStructuredArchiveFromArchive TagArchive(UnderlyingArchive);
+	FStructuredArchive::FStream Stream = TagArchive.GetSlot().EnterStream();
+	GenerateTagIndex(Stream);
+}
+
+//------------------------
+void FDeprecationScope::ReserveRoot()
+{
+	// Reserving so pointers returned by FindProperty are never invalidated.
+	FDeprecationArena::FScope ArenaScope(Tree.GetArena());
+	Tree.GetRoot().Reserve(TagIndex.Num());
+}
+
+//------------------------
+void FDeprecationScope::GenerateRoot()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_GenerateRoot);
+	SCOPE_CYCLE_COUNTER(STAT_Deprecation_GenerateRoot);
 
-	if (CheckDeprecation(AssetVersion))
+	const FDeprecationProperty::Map& Root = Tree.GetRoot();
+
+	// Nothing decoded yet, the whole tree can be read back from a previous load of the object.
+	if (!CacheKey.IsEmpty() && Root.Num() == 0)
 	{
-		Record->GetUnderlyingArchive().Seek(PreSerializePosition);
+		SCOPE_CYCLE_COUNTER(STAT_Deprecation_LoadCachedTree);
+
+		if (FDeprecationTreeCache::Load(CacheKey, *CacheTables, Tree))
+		{
+			CacheKey.Reset();
 
-		FStructuredArchive::FSlot Slot = Record->EnterField(SA_FIELD_NAME(TEXT("Properties")));
-		FStructuredArchive::FStream Stream = Slot.EnterStream();
-		GenerateRoot(Root, Stream);
+			++ClassInfo->Counters.NumCacheHits;
+			INC_DWORD_STAT(STAT_Deprecation_NumCacheHits);
+			return;
+		}
+	}
 
-		if (Handler)
+	for (const FDeprecationTagIndex::FEntry& Entry : TagIndex.GetEntries())
+	{
+		// Properties already decoded on demand are kept as they are. Like FDeprecationTagIndex::Find,
+		// only the first element of a static array makes it to the tree.
+		if (!Root.Contains(Entry.Name))
 		{
-			(Object->*Handler)(Root, AssetVersion, CodeVersion);
+			GenerateProperty(Entry);
 		}
+	}
 
-		Record->GetUnderlyingArchive().Seek(PostSerializePosition);
+	if (!CacheKey.IsEmpty())
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Deprecation_SaveCachedTree);
+
+		FDeprecationTreeCache::Save(CacheKey, *CacheTables, Tree);
+		CacheKey.Reset();
 	}
 }
 
 //------------------------
-bool FDeprecationScope::CheckDeprecation(uint64& AssetVersion)
+void FDeprecationScope::ResolveImports()
 {
-	uint64* AssetVersionPtr = VersionProperty->ContainerPtrToValuePtr<uint64>(Object);
-	AssetVersion = *AssetVersionPtr;
+	if (NumResolvedImports == Tree.GetImports().Num())
+	{
+		return;
+	}
 
-	if (!bAssetHasDeprecationProperty)
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationScope_ResolveImports);
+	SCOPE_CYCLE_COUNTER(STAT_Deprecation_ResolveImports);
+
+	TArray<FString> PackageNames;
+	Tree.ResolveImports(NumResolvedImports, &PackageNames);
+
+	if (PackageNames.Num() > 0)
 	{
-		AssetVersion = 0;
+		// Every package is requested before waiting on any, instead of one blocking load per reference.
+		TArray<int32> RequestIds;
+		RequestIds.Reserve(PackageNames.Num());
+
+		for (const FString& PackageName : PackageNames)
+		{
+			RequestIds.Add(LoadPackageAsync(PackageName));
+		}
+
+		for (int32 RequestId : RequestIds)
+		{
+			FlushAsyncLoading(RequestId);
+		}
+
+		INC_DWORD_STAT_BY(STAT_Deprecation_NumImportPackagesLoaded, PackageNames.Num());
+		Tree.ResolveImports(NumResolvedImports, nullptr);
 	}
 
-	*AssetVersionPtr = CodeVersion;
-	return CodeVersion > AssetVersion;
+	NumResolvedImports = Tree.GetImports().Num();
+}
+
+//------------------------
+FDeprecationProperty& FDeprecationScope::GenerateProperty(const FDeprecationTagIndex::FEntry& Entry)
+{
+	// Everything decoded for the property is allocated in the arena of the tree.
+	FDeprecationArena::FScope ArenaScope(Tree.GetArena());
+
+	FArchive& UnderlyingArchive = Record->GetUnderlyingArchive();
+	UnderlyingArchive.Seek(Entry.ValueOffset);
+
+	FStructuredArchiveFromArchive ValueArchive(UnderlyingArchive);
+	FStructuredArchive::FStream ValueStream = ValueArchive.GetSlot().EnterStream();
+
+	NumDecodedBytes += Entry.Size;
+	ClassInfo->Counters.NumBytesDecoded += Entry.Size;
+	INC_MEMORY_STAT_BY(STAT_Deprecation_NumBytesDecoded, Entry.Size);
+
+	FDeprecationPropertyTag Tag = Entry.MakeTag();
+	FTreeValueSink Sink(Tree, ClassInfo->Counters, (FLinkerLoad*)UnderlyingArchive.GetLinker(), LinkerTables, Tree.GetRoot());
+	Sink.BeginProperty(Tag);
+
+	FDeprecationProperty& TargetProperty = Sink.GetTargetProperty();
+	DecodeValue(Tag, FindStructDecoder(Tag), ValueStream, Sink);
+
+	return TargetProperty;
 }
 
 //------------------------
-void FDeprecationScope::GenerateRoot(FDeprecationProperty::Map& TargetMap,
-	FStructuredArchive::FStream& Stream)
+template <typename SinkType>
+void FDeprecationScope::DecodeStruct(FStructuredArchive::FStream& Stream, SinkType& Sink)
 {
-	FLinkerLoad* Linker = (FLinkerLoad*)(Stream.GetUnderlyingArchive().GetLinker());
+	FArchive& UnderlyingArchive = Stream.GetUnderlyingArchive();
 	while (true)
 	{
 		FStructuredArchive::FRecord PropertyRecord = Stream.EnterElement().EnterRecord();
@@ -172,70 +1885,50 @@ void FDeprecationScope::GenerateRoot(FDeprecationProperty::Map& TargetMap,
 		}
 		if (!Tag.Name.IsValid())
 		{
-			UE_LOG(LogClass, Warning, TEXT("Invalid tag name: struct '%s', archive '%s'"), *Object->GetName(), *Record->GetUnderlyingArchive().GetArchiveName());
+			UE_LOG(LogClass, Warning, TEXT("Invalid tag name: struct '%s', archive '%s'"), *GetNameSafe(Object), *UnderlyingArchive.GetArchiveName());
 			break;
 		}
 
+		// Moving to the next tag from the size of the value, whether it has been decoded or skipped.
+		const int64 NextTagOffset = UnderlyingArchive.Tell() + Tag.Size;
+
 		FStructuredArchive::FStream ValueStream = PropertyRecord.EnterField(SA_FIELD_NAME(TEXT("Value"))).EnterStream();
-		FDeprecationProperty& TargetProperty = MakeProperty(TargetMap, Tag);
-		GenerateValue(Tag, Linker, TargetProperty, false, ValueStream);
+		if (Sink.BeginProperty(Tag))
+		{
+			DecodeValue(Tag, FindStructDecoder(Tag), ValueStream, Sink);
+			Sink.EndProperty(Tag);
+		}
+
+		if (!UnderlyingArchive.IsTextFormat())
+		{
+			UnderlyingArchive.Seek(NextTagOffset);
+		}
 	}
 }
 
 //------------------------
-void FDeprecationScope::GenerateValue(FDeprecationPropertyTag& Tag, FLinkerLoad* Linker,
-	FDeprecationProperty& TargetProperty, bool bIsKey, FStructuredArchive::FStream& ValueStream)
+template <typename SinkType>
+void FDeprecationScope::DecodeValue(FDeprecationPropertyTag& Tag, const FDeprecationStructDecoders::FDecoder& StructDecoder,
+	FStructuredArchive::FStream& ValueStream, SinkType& Sink)
 {
 	// Structures
 	if (Tag.Type == NAME_StructProperty)
 	{
-		ValueStream.EnterElement().EnterRecord().EnterField(SA_FIELD_NAME(TEXT("Properties")));
-
-		//------------------------
-#define BUILTIN_STRUCT(TypeName) \
-		if(Tag.StructName == NAME_##TypeName) { \
-			F##TypeName Value; \
-			ValueStream << Value; \
-			FDeprecationProperty::Variant& Variant = MakeVariant(TargetProperty, bIsKey); \
-			Variant.TypeName = Value; \
-			return; \
-		}
-
-		// Commented lines below mean that there are no implicit converters from Slot.
+		FStructuredArchive::FSlot StructSlot = ValueStream.EnterElement();
 
-		//BUILTIN_STRUCT(BoxSphereBounds);
-		//BUILTIN_STRUCT(Sphere);
-		BUILTIN_STRUCT(Box);
-		BUILTIN_STRUCT(Vector2D);
-		//BUILTIN_STRUCT(IntRect);
-		BUILTIN_STRUCT(IntPoint);
-		//BUILTIN_STRUCT(Vector4);
-		BUILTIN_STRUCT(Vector);
-		//BUILTIN_STRUCT(Rotator);
-		BUILTIN_STRUCT(Color);
-		BUILTIN_STRUCT(Plane);
-		//BUILTIN_STRUCT(Matrix);
-		BUILTIN_STRUCT(LinearColor);
-		//BUILTIN_STRUCT(Quat);
-		//BUILTIN_STRUCT(Transform);
-
-#undef BUILTIN_STRUCT
-
-		FDeprecationProperty::Variant& Variant = MakeVariant(TargetProperty, bIsKey);
-
-		if (bIsKey)
-		{
-			TargetProperty.bHasKeyProperties = true;
-		}
-		else
+		// Natively serialized structures are decoded at once, without nested map.
+		// A size other than the expected one means the structure was saved tagged.
+		if (StructDecoder.Decode && (Tag.Size == INDEX_NONE || Tag.Size == StructDecoder.SerializedSize))
 		{
-			TargetProperty.bHasValueProperties = true;
+			Sink.DecodeNativeStruct(StructDecoder, StructSlot.GetUnderlyingArchive());
+			return;
 		}
 
-		Variant.Properties = new FDeprecationProperty::Map();
-		GenerateRoot(*Variant.Properties, ValueStream);
+		StructSlot.EnterRecord().EnterField(SA_FIELD_NAME(TEXT("Properties")));
 
-		return;
+		Sink.BeginStruct(Tag);
+		DecodeStruct(ValueStream, Sink);
+		Sink.EndStruct();
 	}
 
 	// Arrays
@@ -245,17 +1938,47 @@ void FDeprecationScope::GenerateValue(FDeprecationPropertyTag& Tag, FLinkerLoad*
 		ValueStream << Size;
 
 		FStructuredArchive::FStream ValuesStream = ValueStream.EnterElement().EnterRecord().EnterField(SA_FIELD_NAME(TEXT("Values"))).EnterStream();
+		Sink.BeginArray(Tag, Size);
+
 		FDeprecationPropertyTag ValuePropertyTag = Tag;
 		ValuePropertyTag.Type = Tag.InnerType;
-		
-		for (int32 Index = 0; Index < Size; ++Index)
+		ValuePropertyTag.Size = INDEX_NONE;
+
+		// Primitives are read contiguously instead of one value per element.
+		EDeprecationVariantType PackedType = GetPackedType(Tag.InnerType);
+
+		// Arrays of structures are preceded by a tag naming the structure, with the size of all the elements.
+		if (Tag.InnerType == NAME_StructProperty && ValueStream.GetUnderlyingArchive().UE4Ver() >= VER_UE4_INNER_ARRAY_TAG_INFO)
 		{
-			GenerateValue(ValuePropertyTag, Linker, TargetProperty, bIsKey, ValuesStream);
+			FDeprecationPropertyTag InnerTag;
+			ValuesStream.EnterElement() << InnerTag;
+
+			ValuePropertyTag.StructName = InnerTag.StructName;
+			ValuePropertyTag.Size = Size > 0 ? InnerTag.Size / Size : INDEX_NONE;
+			Sink.SetArrayStructName(InnerTag.StructName);
+
+			// Math structures saved natively are packed like primitives, unless the size shows they were saved tagged.
+			const EDeprecationVariantType PackedStructType = GetPackedStructType(InnerTag.StructName);
+			if (PackedStructType != EDeprecationVariantType::None && InnerTag.Size == (int64)Size * FDeprecationProperty::GetPackedSize(PackedStructType))
+			{
+				PackedType = PackedStructType;
+			}
 		}
 
-		return;
+		if (PackedType == EDeprecationVariantType::None || !CanReadPackedValues(ValueStream.GetUnderlyingArchive(), Size)
+			|| !Sink.ReadPacked(PackedType, ValuesStream.EnterElement().GetUnderlyingArchive(), Size))
+		{
+			const FDeprecationStructDecoders::FDecoder ValueStructDecoder = FindStructDecoder(ValuePropertyTag);
+			for (int32 Index = 0; Index < Size; ++Index)
+			{
+				DecodeValue(ValuePropertyTag, ValueStructDecoder, ValuesStream, Sink);
+			}
+		}
+
+		Sink.EndArray();
 	}
 
+	// Sets
 	else if (Tag.Type == NAME_SetProperty)
 	{
 		FStructuredArchive::FRecord SetRecord = ValueStream.EnterElement().EnterRecord();
@@ -266,16 +1989,25 @@ void FDeprecationScope::GenerateValue(FDeprecationPropertyTag& Tag, FLinkerLoad*
 		int32 Size;
 		FStructuredArchive::FArray ElementArray = SetRecord.EnterArray(SA_FIELD_NAME(TEXT("Elements")), Size);
 
-		FDeprecationPropertyTag ElementPropertyTag = Tag;
-		ElementPropertyTag.Type = Tag.InnerType;
+		Sink.BeginSet(Tag, Size);
 
-		for (int32 Index = 0; Index < Size; ++Index)
+		const EDeprecationVariantType PackedType = GetPackedType(Tag.InnerType);
+		if (PackedType == EDeprecationVariantType::None || !CanReadPackedValues(SetRecord.GetUnderlyingArchive(), Size)
+			|| !Sink.ReadPacked(PackedType, ElementArray.EnterElement().GetUnderlyingArchive(), Size))
 		{
-			FStructuredArchive::FStream ElementStream = ElementArray.EnterElement().EnterStream();
-			GenerateValue(ElementPropertyTag, Linker, TargetProperty, bIsKey, ElementStream);
+			FDeprecationPropertyTag ElementPropertyTag = Tag;
+			ElementPropertyTag.Type = Tag.InnerType;
+			ElementPropertyTag.Size = INDEX_NONE;
+
+			const FDeprecationStructDecoders::FDecoder ElementStructDecoder = FindStructDecoder(ElementPropertyTag);
+			for (int32 Index = 0; Index < Size; ++Index)
+			{
+				FStructuredArchive::FStream ElementStream = ElementArray.EnterElement().EnterStream();
+				DecodeValue(ElementPropertyTag, ElementStructDecoder, ElementStream, Sink);
+			}
 		}
 
-		return;
+		Sink.EndSet();
 	}
 
 	// Maps
@@ -289,47 +2021,42 @@ void FDeprecationScope::GenerateValue(FDeprecationPropertyTag& Tag, FLinkerLoad*
 		int32 NumEntries;
 		FStructuredArchive::FArray EntriesArray = MapRecord.EnterArray(SA_FIELD_NAME(TEXT("Entries")), NumEntries);
 
+		Sink.BeginMap(Tag, NumEntries);
+
 		FDeprecationPropertyTag KeyPropertyTag = Tag;
 		KeyPropertyTag.Type = Tag.InnerType;
+		KeyPropertyTag.Size = INDEX_NONE;
 
 		FDeprecationPropertyTag ValuePropertyTag = Tag;
 		ValuePropertyTag.Type = Tag.ValueType;
+		ValuePropertyTag.Size = INDEX_NONE;
+
+		const FDeprecationStructDecoders::FDecoder KeyStructDecoder = FindStructDecoder(KeyPropertyTag);
+		const FDeprecationStructDecoders::FDecoder ValueStructDecoder = FindStructDecoder(ValuePropertyTag);
 
 		for (int32 Index = 0; Index < NumEntries; ++Index)
 		{
 			FStructuredArchive::FRecord EntryRecord = EntriesArray.EnterElement().EnterRecord();
 
 			FStructuredArchive::FStream EntryKeyStream = EntryRecord.EnterField(SA_FIELD_NAME(TEXT("Key"))).EnterStream();
-			GenerateValue(KeyPropertyTag, Linker, TargetProperty, true, EntryKeyStream);
+			Sink.BeginMapKey();
+			DecodeValue(KeyPropertyTag, KeyStructDecoder, EntryKeyStream, Sink);
 
 			FStructuredArchive::FStream EntryValueStream = EntryRecord.EnterField(SA_FIELD_NAME(TEXT("Value"))).EnterStream();
-			GenerateValue(ValuePropertyTag, Linker, TargetProperty, false, EntryValueStream);
+			Sink.BeginMapValue();
+			DecodeValue(ValuePropertyTag, ValueStructDecoder, EntryValueStream, Sink);
 		}
 
-		return;
+		Sink.EndMap();
 	}
 
-	FDeprecationProperty::Variant& Variant = MakeVariant(TargetProperty, bIsKey);
-
 	// Objects
-	if (Tag.Type == NAME_ObjectProperty)
+	else if (Tag.Type == NAME_ObjectProperty)
 	{
 		FPackageIndex PackageIndex;
 		ValueStream << PackageIndex;
 
-		if (Linker)
-		{
-			if (PackageIndex.IsImport())
-			{
-				FObjectImport ObjImport = Linker->Imp(PackageIndex);
-				Variant.ObjectImport = ObjImport;
-			}
-			else
-			{
-				FObjectExport ObjExport = Linker->Exp(PackageIndex);
-				Variant.XObject = ObjExport.Object;
-			}
-		}
+		Sink.VisitObject(PackageIndex);
 	}
 
 	// Soft Objects
@@ -338,13 +2065,13 @@ void FDeprecationScope::GenerateValue(FDeprecationPropertyTag& Tag, FLinkerLoad*
 		FSoftObjectPath PackagePath;
 		ValueStream << PackagePath;
 
-		Variant.Name = PackagePath.GetAssetPathName();
+		Sink.VisitSoftObjectPath(PackagePath);
 	}
 
 	// Booleans
 	else if (Tag.Type == NAME_BoolProperty)
 	{
-		Variant.bBool = Tag.BoolVal != 0;
+		Sink.VisitValue(ReadBoolValue(Tag, ValueStream));
 	}
 
 	// Strings
@@ -353,30 +2080,56 @@ void FDeprecationScope::GenerateValue(FDeprecationPropertyTag& Tag, FLinkerLoad*
 		FString Value;
 		ValueStream << Value;
 
-		Variant.SetString(Value);
+		Sink.VisitString(Value);
 	}
 
 	// Builtins
 	else
 	{
-#define BUILTIN_TYPE(Name, CppType, VariantField) if(Tag.Type == Name){ CppType Value; ValueStream << Value; Variant.VariantField = Value; return; }
+#define BUILTIN_TYPE(Name, CppType) if(Tag.Type == Name){ CppType Value; ValueStream << Value; Sink.VisitValue(Value); return; }
 
-		BUILTIN_TYPE(NAME_Int8Property, int8, Int8);
-		BUILTIN_TYPE(NAME_Int16Property, int16, Int16);
-		BUILTIN_TYPE(NAME_IntProperty, int32, Int32);
-		BUILTIN_TYPE(NAME_Int64Property, int64, Int64);
+		BUILTIN_TYPE(NAME_Int8Property, int8);
+		BUILTIN_TYPE(NAME_Int16Property, int16);
+		BUILTIN_TYPE(NAME_IntProperty, int32);
+		BUILTIN_TYPE(NAME_Int64Property, int64);
 
-		BUILTIN_TYPE(NAME_ByteProperty, uint8, UInt8);
-		BUILTIN_TYPE(NAME_UInt16Property, uint16, UInt16);
-		BUILTIN_TYPE(NAME_UInt32Property, uint32, UInt32);
-		BUILTIN_TYPE(NAME_UInt64Property, uint64, UInt64);
+		BUILTIN_TYPE(NAME_ByteProperty, uint8);
+		BUILTIN_TYPE(NAME_UInt16Property, uint16);
+		BUILTIN_TYPE(NAME_UInt32Property, uint32);
+		BUILTIN_TYPE(NAME_UInt64Property, uint64);
 
-		BUILTIN_TYPE(NAME_FloatProperty, float, Float);
-		BUILTIN_TYPE(NAME_DoubleProperty, double, Double);
+		BUILTIN_TYPE(NAME_FloatProperty, float);
+		BUILTIN_TYPE(NAME_DoubleProperty, double);
 
-		BUILTIN_TYPE(NAME_NameProperty, FName, Name);
-		BUILTIN_TYPE(NAME_EnumProperty, FName, Name);
+		BUILTIN_TYPE(NAME_NameProperty, FName);
+		BUILTIN_TYPE(NAME_EnumProperty, FName);
 
 #undef BUILTIN_TYPE
+
+		Sink.SkipValue();
+	}
+}
+
+//------------------------
+void FDeprecationScope::VisitProperty(const FDeprecationTagIndex::FEntry& Entry, IDeprecationPropertyVisitor& Visitor)
+{
+	FArchive& UnderlyingArchive = Record->GetUnderlyingArchive();
+
+	FDeprecationPropertyTag Tag = Entry.MakeTag();
+	FVisitorValueSink Sink(Visitor, (FLinkerLoad*)UnderlyingArchive.GetLinker(), LinkerTables);
+	if (!Sink.BeginProperty(Tag))
+	{
+		return;
 	}
-}
\ No newline at end of file
+
+	UnderlyingArchive.Seek(Entry.ValueOffset);
+
+	FStructuredArchiveFromArchive ValueArchive(UnderlyingArchive);
+	FStructuredArchive::FStream ValueStream = ValueArchive.GetSlot().EnterStream();
+
+	ClassInfo->Counters.NumBytesDecoded += Entry.Size;
+	INC_MEMORY_STAT_BY(STAT_Deprecation_NumBytesDecoded, Entry.Size);
+
+	DecodeValue(Tag, FindStructDecoder(Tag), ValueStream, Sink);
+	Sink.EndProperty(Tag);
+}
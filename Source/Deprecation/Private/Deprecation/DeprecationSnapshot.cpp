@@ -0,0 +1,206 @@
+#include "Deprecation/DeprecationSnapshot.h"
+
+#include "Misc/ScopeLock.h"
+#include "UObject/LinkerLoad.h"
+
+//------------------------
+namespace
+{
+	//------------------------
+	struct FCachedTables
+	{
+		/** Package of the linker the tables were copied from, a new linker may be allocated at the same address. */
+		const UPackage* Package = nullptr;
+
+		TWeakPtr<const FDeprecationLinkerTables, ESPMode::ThreadSafe> Tables;
+	};
+
+	//------------------------
+	FCriticalSection TablesLock;
+	TMap<const FLinkerLoad*, FCachedTables> CachedTables;
+
+	//------------------------
+	int32 CountMissingExports(const FLinkerLoad& Linker)
+	{
+		int32 NumMissingExports = 0;
+
+		for (const FObjectExport& Export : Linker.ExportMap)
+		{
+			if (!Export.Object)
+			{
+				++NumMissingExports;
+			}
+		}
+
+		return NumMissingExports;
+	}
+
+	//------------------------
+	void CopyExports(const FLinkerLoad& Linker, FDeprecationLinkerTables& Tables)
+	{
+		Tables.Exports.Reset(Linker.ExportMap.Num());
+		Tables.NumMissingExports = 0;
+
+		for (const FObjectExport& Export : Linker.ExportMap)
+		{
+			Tables.Exports.Add(Export.Object);
+
+			if (!Export.Object)
+			{
+				++Tables.NumMissingExports;
+			}
+		}
+	}
+
+	//------------------------
+	void CopyTables(FLinkerLoad& Linker, FDeprecationLinkerTables& Tables)
+	{
+		Tables.Names = Linker.NameMap;
+		Tables.Imports = Linker.ImportMap;
+
+		// Paths are built once per package, instead of once per reference.
+		Tables.ImportPaths.Reserve(Linker.ImportMap.Num());
+		for (int32 ImportIndex = 0; ImportIndex < Linker.ImportMap.Num(); ++ImportIndex)
+		{
+			Tables.ImportPaths.Emplace(Linker.GetImportPathName(ImportIndex));
+		}
+
+		CopyExports(Linker, Tables);
+
+		Tables.ArchiveName = Linker.GetArchiveName();
+		Tables.CustomVersions = Linker.GetCustomVersions();
+		Tables.EngineVersion = Linker.EngineVer();
+		Tables.UE4Version = Linker.UE4Ver();
+		Tables.LicenseeUE4Version = Linker.LicenseeUE4Ver();
+		Tables.bIsByteSwapping = Linker.IsByteSwapping();
+	}
+}
+
+//------------------------
+FDeprecationSnapshot::FDeprecationSnapshot(FLinkerLoad& Linker, int64 Offset, int64 Size)
+	: Offset(Offset)
+	, Tables(FindOrAddTables(Linker))
+{
+	Bytes.SetNumUninitialized(Size);
+
+	Linker.Seek(Offset);
+	Linker.Serialize(Bytes.GetData(), Size);
+}
+
+//------------------------
+FDeprecationLinkerTablesPtr FDeprecationSnapshot::FindOrAddTables(FLinkerLoad& Linker)
+{
+	FScopeLock ScopeLock(&TablesLock);
+
+	FCachedTables& Cached = CachedTables.FindOrAdd(&Linker);
+	FDeprecationLinkerTablesPtr Tables = Cached.Tables.Pin();
+
+	if (Tables.IsValid() && Cached.Package == Linker.LinkerRoot)
+	{
+		// Exports are created while the package loads, references to the new ones need new tables.
+		if (Tables->NumMissingExports == 0 || CountMissingExports(Linker) == Tables->NumMissingExports)
+		{
+			return Tables;
+		}
+
+		TSharedRef<FDeprecationLinkerTables, ESPMode::ThreadSafe> NewTables = MakeShared<FDeprecationLinkerTables, ESPMode::ThreadSafe>(*Tables);
+		CopyExports(Linker, *NewTables);
+
+		Cached.Tables = NewTables;
+		return NewTables;
+	}
+
+	TSharedRef<FDeprecationLinkerTables, ESPMode::ThreadSafe> NewTables = MakeShared<FDeprecationLinkerTables, ESPMode::ThreadSafe>();
+	CopyTables(Linker, *NewTables);
+
+	Cached.Package = Linker.LinkerRoot;
+	Cached.Tables = NewTables;
+
+	// Tables are released with the last snapshot taken from them, so are the entries of their linkers.
+	for (auto It = CachedTables.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().Tables.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	return NewTables;
+}
+
+//------------------------
+FDeprecationSnapshotReader::FDeprecationSnapshotReader(const FDeprecationSnapshot& Snapshot)
+	: Snapshot(Snapshot)
+	, Cursor(0)
+{
+	const FDeprecationLinkerTables& Tables = *Snapshot.Tables;
+
+	SetIsLoading(true);
+	SetIsPersistent(true);
+	SetUE4Ver(Tables.UE4Version);
+	SetLicenseeUE4Ver(Tables.LicenseeUE4Version);
+	SetEngineVer(Tables.EngineVersion);
+	SetCustomVersions(Tables.CustomVersions);
+	SetByteSwapping(Tables.bIsByteSwapping);
+}
+
+//------------------------
+void FDeprecationSnapshotReader::Serialize(void* Data, int64 Num)
+{
+	if (Num < 0 || Cursor < 0 || Cursor + Num > Snapshot.Bytes.Num())
+	{
+		SetError();
+		FMemory::Memzero(Data, FMath::Max<int64>(Num, 0));
+		return;
+	}
+
+	FMemory::Memcpy(Data, Snapshot.Bytes.GetData() + Cursor, Num);
+	Cursor += Num;
+}
+
+//------------------------
+FArchive& FDeprecationSnapshotReader::operator<<(FName& Name)
+{
+	// Same layout as FLinkerLoad: index in the name map, then number.
+	int32 NameIndex = 0;
+	int32 Number = 0;
+	*this << NameIndex << Number;
+
+	const TArray<FNameEntryId>& Names = Snapshot.Tables->Names;
+	if (!Names.IsValidIndex(NameIndex))
+	{
+		UE_LOG(LogClass, Warning, TEXT("Bad name index %d/%d: archive '%s'"), NameIndex, Names.Num(), *GetArchiveName());
+		SetError();
+
+		Name = NAME_None;
+		return *this;
+	}
+
+	const FNameEntryId MappedName = Names[NameIndex];
+	Name = FName::CreateFromDisplayId(MappedName, MappedName ? Number : 0);
+	return *this;
+}
+
+//------------------------
+FString FDeprecationSnapshotReader::GetArchiveName() const
+{
+	return Snapshot.Tables->ArchiveName;
+}
+
+//------------------------
+int64 FDeprecationSnapshotReader::Tell()
+{
+	return Snapshot.Offset + Cursor;
+}
+
+//------------------------
+void FDeprecationSnapshotReader::Seek(int64 InPosition)
+{
+	Cursor = InPosition - Snapshot.Offset;
+}
+
+//------------------------
+int64 FDeprecationSnapshotReader::TotalSize()
+{
+	return Snapshot.Offset + Snapshot.Bytes.Num();
+}
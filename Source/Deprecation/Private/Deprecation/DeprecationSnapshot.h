@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/Archive.h"
+#include "Serialization/CustomVersion.h"
+#include "UObject/ObjectResource.h"
+#include "UObject/SoftObjectPath.h"
+
+class FLinkerLoad;
+
+/**
+ * Tables of a package needed to decode its property data away from its linker: names, imports and exports.
+ * Copied once per linker and shared by the snapshots taken from it, immutable once copied.
+ */
+struct FDeprecationLinkerTables
+{
+	TArray<FNameEntryId> Names;
+
+	TArray<FObjectImport> Imports;
+
+	/** Full path of each import, see FLinkerLoad::GetImportPathName. */
+	TArray<FSoftObjectPath> ImportPaths;
+
+	/** Object of each export when copied, null for the ones not created yet. */
+	TArray<UObject*> Exports;
+	int32 NumMissingExports = 0;
+
+	FString ArchiveName;
+	FCustomVersionContainer CustomVersions;
+	FEngineVersionBase EngineVersion;
+	int32 UE4Version = 0;
+	int32 LicenseeUE4Version = 0;
+	bool bIsByteSwapping = false;
+};
+
+typedef TSharedPtr<const FDeprecationLinkerTables, ESPMode::ThreadSafe> FDeprecationLinkerTablesPtr;
+
+/**
+ * Raw property data of an object, copied out of its archive so it can be decoded on a worker thread.
+ */
+struct FDeprecationSnapshot
+{
+	/**
+	 * Copies the property data of an object from the linker loading it.
+	 * @param Linker Linker loading the object, positioned anywhere.
+	 * @param Offset Position in the file of the first byte to copy.
+	 * @param Size Number of bytes to copy.
+	 */
+	FDeprecationSnapshot(FLinkerLoad& Linker, int64 Offset, int64 Size);
+
+	/**
+	 * Retrieves the tables of a linker, copying them on first request (and again once more of its exports exist).
+	 * Must be called while the linker is loading.
+	 * @param Linker Linker to retrieve the tables of.
+	 * @returns Tables shared by all the snapshots taken from the linker.
+	 */
+	static FDeprecationLinkerTablesPtr FindOrAddTables(FLinkerLoad& Linker);
+
+	TArray<uint8> Bytes;
+
+	/** Position in the file of the first byte. */
+	int64 Offset;
+
+	FDeprecationLinkerTablesPtr Tables;
+};
+
+/**
+ * Reads a snapshot like its linker would: same positions, versions and names.
+ */
+class FDeprecationSnapshotReader final : public FArchive
+{
+	// Constructors
+public:
+	/**
+	 * @param Snapshot Snapshot to read, must outlive the reader.
+	 */
+	FDeprecationSnapshotReader(const FDeprecationSnapshot& Snapshot);
+
+
+
+
+	// Methods
+public:
+	virtual void Serialize(void* Data, int64 Num) override;
+
+	virtual FArchive& operator<<(FName& Name) override;
+
+	virtual FString GetArchiveName() const override;
+
+	virtual int64 Tell() override;
+
+	virtual void Seek(int64 InPosition) override;
+
+	virtual int64 TotalSize() override;
+
+
+
+
+	// Fields
+private:
+	const FDeprecationSnapshot& Snapshot;
+
+	/** Position in the bytes of the snapshot. */
+	int64 Cursor;
+};
@@ -0,0 +1,60 @@
+#include "Deprecation/DeprecationSteps.h"
+
+#include "Deprecation/DeprecationRegistry.h"
+
+//------------------------
+FDeprecationSteps::FRegistrar::FRegistrar(ClassGetter GetClass, const TCHAR* VersionPropertyName, RegisterFunction Register)
+{
+	FDeprecationRegistry::Get().AddSteps(GetClass, VersionPropertyName, Register);
+}
+
+//------------------------
+void FDeprecationSteps::Sort()
+{
+	Steps.StableSort([](const FStep& A, const FStep& B)
+	{
+		return A.Version < B.Version;
+	});
+}
+
+//------------------------
+bool FDeprecationSteps::Validate(const UClass* Class, uint64 CodeVersion) const
+{
+	bool bIsValid = true;
+
+	for (int32 Index = 0; Index < Steps.Num(); ++Index)
+	{
+		const FStep& Step = Steps[Index];
+
+		if (!ensureAlwaysMsgf(Step.Handler, TEXT("Step to version %llu of class '%s' has no handler."), Step.Version, *Class->GetName()))
+		{
+			bIsValid = false;
+		}
+
+		if (!ensureAlwaysMsgf(Step.Version > 0 && Step.Version <= CodeVersion, TEXT("Step to version %llu of class '%s' is out of the versions of the code (1 to %llu)."),
+			Step.Version, *Class->GetName(), CodeVersion))
+		{
+			bIsValid = false;
+		}
+
+		// Sorted, so two steps of the same version are next to each other.
+		if (!ensureAlwaysMsgf(Index == 0 || Steps[Index - 1].Version != Step.Version, TEXT("Class '%s' has several steps to version %llu."),
+			*Class->GetName(), Step.Version))
+		{
+			bIsValid = false;
+		}
+	}
+
+	return bIsValid;
+}
+
+//------------------------
+FDeprecationSteps& FDeprecationSteps::AddStep(uint64 Version, StepHandler Handler, TArray<FName>&& Properties)
+{
+	FStep& Step = Steps.AddDefaulted_GetRef();
+	Step.Version = Version;
+	Step.Handler = Handler;
+	Step.Properties = MoveTemp(Properties);
+
+	return *this;
+}
@@ -0,0 +1,53 @@
+#include "Deprecation/DeprecationStructDecoders.h"
+
+//------------------------
+FDeprecationStructDecoders::FDeprecationStructDecoders()
+{
+	// Serialized sizes are the ones of the binary layout, read member by member.
+	Add<FBox>(TEXT("Box"), 25);
+	Add<FVector2D>(TEXT("Vector2D"), 8);
+	Add<FIntRect>(TEXT("IntRect"), 16);
+	Add<FIntPoint>(TEXT("IntPoint"), 8);
+	Add<FVector4>(TEXT("Vector4"), 16);
+	Add<FVector>(TEXT("Vector"), 12);
+	Add<FRotator>(TEXT("Rotator"), 12);
+	Add<FColor>(TEXT("Color"), 4);
+	Add<FPlane>(TEXT("Plane"), 16);
+	Add<FMatrix>(TEXT("Matrix"), 64);
+	Add<FLinearColor>(TEXT("LinearColor"), 16);
+	Add<FQuat>(TEXT("Quat"), 16);
+	Add<FTransform>(TEXT("Transform"), 40);
+	Add<FSphere>(TEXT("Sphere"), 16);
+	Add<FBoxSphereBounds>(TEXT("BoxSphereBounds"), 28);
+}
+
+//------------------------
+FDeprecationStructDecoders& FDeprecationStructDecoders::Get()
+{
+	static FDeprecationStructDecoders Instance;
+	return Instance;
+}
+
+//------------------------
+void FDeprecationStructDecoders::Add(FName StructName, DecodeFunction Decode, int32 SerializedSize)
+{
+	FRWScopeLock ScopeLock(Lock, SLT_Write);
+
+	FDecoder& Decoder = Decoders.FindOrAdd(StructName);
+	Decoder.Decode = Decode;
+	Decoder.SerializedSize = SerializedSize;
+}
+
+//------------------------
+bool FDeprecationStructDecoders::Find(FName StructName, FDecoder& OutDecoder) const
+{
+	FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+
+	if (const FDecoder* Decoder = Decoders.Find(StructName))
+	{
+		OutDecoder = *Decoder;
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,816 @@
+#include "Deprecation/DeprecationTreeCache.h"
+
+#include "Deprecation/DeprecationPropertyTree.h"
+#include "Deprecation/DeprecationSnapshot.h"
+
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/LinkerLoad.h"
+
+//------------------------
+namespace
+{
+#if !UE_BUILD_SHIPPING
+	//------------------------
+	TAutoConsoleVariable<int32> CVarPersistentCache(
+		TEXT("Deprecation.PersistentCache"),
+		0,
+		TEXT("Caches the trees decoded for upgrades in the saved directory of the project, so loading the same outdated asset again\n")
+		TEXT("reads its tree back instead of decoding its properties. Saving a package invalidates the trees of its objects."));
+#endif // !UE_BUILD_SHIPPING
+
+	//------------------------
+	TAutoConsoleVariable<int32> CVarPersistentCacheMaxAgeDays(
+		TEXT("Deprecation.PersistentCacheMaxAgeDays"),
+		30,
+		TEXT("Age in days after which the files of Deprecation.PersistentCache are deleted, 0 to keep them.\n")
+		TEXT("Files are pruned once per session, when the first tree is written."));
+
+	//------------------------
+	const uint32 CacheFileMagic = 0x43545044;
+
+	/** Bumped whenever the layout of the files changes, older files are then ignored. */
+	const uint32 CacheFileVersion = 2;
+
+	// Types written as laid out in memory.
+#define DEPRECATION_RAW_VARIANT_TYPES(Op) \
+	Op(Int8, int8) \
+	Op(Int16, int16) \
+	Op(Int32, int32) \
+	Op(Int64, int64) \
+	Op(UInt8, uint8) \
+	Op(UInt16, uint16) \
+	Op(UInt32, uint32) \
+	Op(UInt64, uint64) \
+	Op(Float, float) \
+	Op(Double, double) \
+	Op(Box, FBox) \
+	Op(Box2D, FBox2D) \
+	Op(Vector2D, FVector2D) \
+	Op(IntRect, FIntRect) \
+	Op(IntPoint, FIntPoint) \
+	Op(Vector4, FVector4) \
+	Op(Vector, FVector) \
+	Op(Rotator, FRotator) \
+	Op(Color, FColor) \
+	Op(Plane, FPlane) \
+	Op(Matrix, FMatrix) \
+	Op(LinearColor, FLinearColor) \
+	Op(Quat, FQuat) \
+	Op(Transform, FTransform) \
+	Op(Sphere, FSphere) \
+	Op(BoxSphereBounds, FBoxSphereBounds)
+
+	//------------------------
+	FString HashString(const FString& Value)
+	{
+		// Hashing UTF-8 so the file is the same whatever the size of TCHAR on the platform.
+		FTCHARToUTF8 ValueUtf8(*Value);
+
+		FSHAHash Hash;
+		FSHA1::HashBuffer(ValueUtf8.Get(), ValueUtf8.Length(), Hash.Hash);
+		return Hash.ToString();
+	}
+
+	//------------------------
+	FString GetCacheDir()
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DeprecationCache"));
+	}
+
+	//------------------------
+	FString GetCacheFilePrefix(const FString& Key)
+	{
+		// Keys start with the path of the object (see FDeprecationTreeCache::MakeKey), every tree of the object shares the prefix.
+		FString ObjectPath;
+		Key.Split(TEXT("|"), &ObjectPath, nullptr);
+		return HashString(ObjectPath) + TEXT("_");
+	}
+
+	//------------------------
+	FString GetCachePath(const FString& Key)
+	{
+		return FPaths::Combine(GetCacheDir(), GetCacheFilePrefix(Key) + HashString(Key) + TEXT(".bin"));
+	}
+
+	//------------------------
+	void PruneOldFiles()
+	{
+		const int32 MaxAgeDays = CVarPersistentCacheMaxAgeDays.GetValueOnAnyThread();
+		if (MaxAgeDays <= 0)
+		{
+			return;
+		}
+
+		const FDateTime MinModificationTime = FDateTime::UtcNow() - FTimespan::FromDays(MaxAgeDays);
+
+		TArray<FString> OldFiles;
+		IFileManager::Get().IterateDirectoryStat(*GetCacheDir(), [&OldFiles, MinModificationTime](const TCHAR* FilenameOrDirectory, const FFileStatData& StatData)
+		{
+			if (!StatData.bIsDirectory && StatData.ModificationTime < MinModificationTime)
+			{
+				OldFiles.Add(FilenameOrDirectory);
+			}
+			return true;
+		});
+
+		for (const FString& OldFile : OldFiles)
+		{
+			IFileManager::Get().Delete(*OldFile, false, false, true);
+		}
+	}
+
+	//------------------------
+	void WriteCacheFile(const FString& Key, const TArray<uint8>& Bytes)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationTreeCache_Write);
+
+		// Files left behind by previous sessions (objects never loaded again, removed classes, ...) are pruned by age.
+		static TAtomic<bool> bHasPrunedOldFiles(false);
+		if (!bHasPrunedOldFiles.Exchange(true))
+		{
+			PruneOldFiles();
+		}
+
+		// Written aside then moved, loads of the same object on other threads never read a partial file.
+		const FString Path = GetCachePath(Key);
+		const FString TempPath = Path + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+
+		if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath))
+		{
+			return;
+		}
+
+		if (!IFileManager::Get().Move(*Path, *TempPath, true, true, false, true))
+		{
+			IFileManager::Get().Delete(*TempPath, false, false, true);
+			return;
+		}
+
+		// Trees of the previous saves of the package (or of other versions) are never read again, only the last one of the object is kept.
+		const FString Prefix = GetCacheFilePrefix(Key);
+		const FString FileName = FPaths::GetCleanFilename(Path);
+
+		TArray<FString> ObjectFileNames;
+		IFileManager::Get().FindFiles(ObjectFileNames, *FPaths::Combine(GetCacheDir(), Prefix + TEXT("*.bin")), true, false);
+
+		for (const FString& ObjectFileName : ObjectFileNames)
+		{
+			if (ObjectFileName != FileName)
+			{
+				IFileManager::Get().Delete(*FPaths::Combine(GetCacheDir(), ObjectFileName), false, false, true);
+			}
+		}
+	}
+
+	//------------------------
+	bool IsPackedType(EDeprecationVariantType Type)
+	{
+		// Same types as FDeprecationProperty::GetPackedSize.
+		switch (Type)
+		{
+		case EDeprecationVariantType::Bool:
+		case EDeprecationVariantType::Int8:
+		case EDeprecationVariantType::Int16:
+		case EDeprecationVariantType::Int32:
+		case EDeprecationVariantType::Int64:
+		case EDeprecationVariantType::UInt8:
+		case EDeprecationVariantType::UInt16:
+		case EDeprecationVariantType::UInt32:
+		case EDeprecationVariantType::UInt64:
+		case EDeprecationVariantType::Float:
+		case EDeprecationVariantType::Double:
+		case EDeprecationVariantType::Vector2D:
+		case EDeprecationVariantType::IntRect:
+		case EDeprecationVariantType::IntPoint:
+		case EDeprecationVariantType::Vector4:
+		case EDeprecationVariantType::Vector:
+		case EDeprecationVariantType::Rotator:
+		case EDeprecationVariantType::Color:
+		case EDeprecationVariantType::Plane:
+		case EDeprecationVariantType::Matrix:
+		case EDeprecationVariantType::LinearColor:
+		case EDeprecationVariantType::Quat:
+		case EDeprecationVariantType::Sphere:
+		case EDeprecationVariantType::BoxSphereBounds:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	//------------------------
+	class FTreeWriter final
+	{
+	public:
+		FTreeWriter(const FDeprecationLinkerTables& Tables, const FDeprecationPropertyTree& Tree)
+			: Body(BodyBytes)
+		{
+			for (const FDeprecationPropertyTree::FImport& Import : Tree.GetImports())
+			{
+				ImportPaths.Add(Import.ObjectImport, &Import.Path);
+			}
+
+			for (int32 ExportIndex = 0; ExportIndex < Tables.Exports.Num(); ++ExportIndex)
+			{
+				if (Tables.Exports[ExportIndex])
+				{
+					ExportIndices.Add(Tables.Exports[ExportIndex], ExportIndex);
+				}
+			}
+		}
+
+		bool WriteMap(const FDeprecationProperty::Map& Map)
+		{
+			int32 NumProperties = Map.Num();
+			Body << NumProperties;
+
+			for (const TPair<FName, FDeprecationProperty>& Pair : Map)
+			{
+				WriteName(Pair.Key);
+				if (!WriteProperty(Pair.Value))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		/**
+		 * Assembles the file: header, names, then the maps written so far.
+		 */
+		void Finish(const FString& Key, TArray<uint8>& OutBytes)
+		{
+			FMemoryWriter File(OutBytes);
+
+			uint32 Magic = CacheFileMagic;
+			uint32 Version = CacheFileVersion;
+			FString FileKey = Key;
+			File << Magic << Version << FileKey;
+
+			int32 NumNames = Names.Num();
+			File << NumNames;
+
+			for (FName Name : Names)
+			{
+				FString NameString = Name.ToString();
+				File << NameString;
+			}
+
+			File.Serialize(BodyBytes.GetData(), BodyBytes.Num());
+		}
+
+	private:
+		bool WriteProperty(const FDeprecationProperty& Property)
+		{
+			WriteName(Property.PropertyName);
+			WriteName(Property.PropertyTypeName);
+			WriteName(Property.StructTypeName);
+			WriteName(Property.InnerTypeName);
+			WriteName(Property.MapValueTypeName);
+
+			int32 NumKeys = Property.Keys.Num();
+			Body << NumKeys;
+
+			for (const FDeprecationProperty::Variant& Key : Property.Keys)
+			{
+				if (!WriteVariant(Key))
+				{
+					return false;
+				}
+			}
+
+			uint8 PackedValueType = (uint8)Property.PackedValueType;
+			Body << PackedValueType;
+
+			if (Property.IsPacked())
+			{
+				int32 NumBytes = Property.PackedValues.Num();
+				Body << NumBytes;
+				Body.Serialize(const_cast<uint8*>(Property.PackedValues.GetData()), NumBytes);
+				return true;
+			}
+
+			int32 NumValues = Property.Values.Num();
+			Body << NumValues;
+
+			for (const FDeprecationProperty::Variant& Value : Property.Values)
+			{
+				if (!WriteVariant(Value))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool WriteVariant(const FDeprecationProperty::Variant& Variant)
+		{
+			uint8 Type = (uint8)Variant.GetType();
+			Body << Type;
+
+			switch (Variant.GetType())
+			{
+			case EDeprecationVariantType::None:
+				return true;
+
+			case EDeprecationVariantType::Bool:
+				{
+					uint8 Value = Variant.Get<bool>() ? 1 : 0;
+					Body << Value;
+				}
+				return true;
+
+#define RAW_TYPE(VariantType, CppType) \
+			case EDeprecationVariantType::VariantType: \
+				{ \
+					CppType Value = Variant.Get<CppType>(); \
+					Body.Serialize(&Value, sizeof(CppType)); \
+				} \
+				return true;
+
+				DEPRECATION_RAW_VARIANT_TYPES(RAW_TYPE)
+
+#undef RAW_TYPE
+
+			case EDeprecationVariantType::Name:
+				WriteName(Variant.Get<FName>());
+				return true;
+
+			case EDeprecationVariantType::String:
+			case EDeprecationVariantType::SoftObjectPath:
+				WriteString(Variant.GetStringView());
+				return true;
+
+			case EDeprecationVariantType::ObjectImport:
+				{
+					const FObjectImport& Import = Variant.Get<FObjectImport>();
+					const FSoftObjectPath* const* Path = ImportPaths.Find(&Import);
+					if (!Path)
+					{
+						return false;
+					}
+
+					WriteName(Import.ClassPackage);
+					WriteName(Import.ClassName);
+					WriteName(Import.ObjectName);
+
+					FPackageIndex OuterIndex = Import.OuterIndex;
+					Body << OuterIndex;
+
+					const FString PathString = (*Path)->ToString();
+					WriteString(FStringView(*PathString, PathString.Len()));
+				}
+				return true;
+
+			case EDeprecationVariantType::Object:
+				{
+					// Exports are written by index, they are the same objects for every load of the package.
+					UObject* Object = Variant.Get<UObject*>();
+					const int32* ExportIndex = Object ? ExportIndices.Find(Object) : nullptr;
+					if (Object && !ExportIndex)
+					{
+						return false;
+					}
+
+					int32 Index = ExportIndex ? *ExportIndex : INDEX_NONE;
+					Body << Index;
+				}
+				return true;
+
+			case EDeprecationVariantType::Properties:
+				return WriteMap(*Variant.GetProperties());
+
+				// Project structures are only known by the code reading them.
+			default:
+				return false;
+			}
+		}
+
+		void WriteName(FName Name)
+		{
+			const int32* Index = NameIndices.Find(Name);
+			int32 NameIndex = Index ? *Index : NameIndices.Add(Name, Names.Add(Name));
+			Body << NameIndex;
+		}
+
+		void WriteString(FStringView String)
+		{
+			int32 Len = String.Len();
+			Body << Len;
+			Body.Serialize(const_cast<TCHAR*>(String.GetData()), Len * sizeof(TCHAR));
+		}
+
+	private:
+		TArray<uint8> BodyBytes;
+		FMemoryWriter Body;
+
+		TArray<FName> Names;
+		TMap<FName, int32> NameIndices;
+
+		TMap<const FObjectImport*, const FSoftObjectPath*> ImportPaths;
+		TMap<const UObject*, int32> ExportIndices;
+	};
+
+	//------------------------
+	class FTreeReader final
+	{
+	public:
+		FTreeReader(const TArray<uint8>& Bytes, const FDeprecationLinkerTables& Tables, FDeprecationPropertyTree& Tree)
+			: Reader(Bytes)
+			, Tables(Tables)
+			, Tree(Tree)
+		{
+		}
+
+		/**
+		 * Reads the header and the names, fails if the file has another key or layout.
+		 */
+		bool ReadHeader(const FString& Key)
+		{
+			uint32 Magic = 0;
+			uint32 Version = 0;
+			Reader << Magic << Version;
+
+			if (Reader.IsError() || Magic != CacheFileMagic || Version != CacheFileVersion)
+			{
+				return false;
+			}
+
+			FString FileKey;
+			Reader << FileKey;
+
+			int32 NumNames = 0;
+			Reader << NumNames;
+
+			if (Reader.IsError() || FileKey != Key || !IsValidCount(NumNames))
+			{
+				return false;
+			}
+
+			Names.Reserve(NumNames);
+			for (int32 Index = 0; Index < NumNames; ++Index)
+			{
+				FString NameString;
+				Reader << NameString;
+				Names.Add(FName(*NameString));
+			}
+
+			return !Reader.IsError();
+		}
+
+		bool ReadMap(FDeprecationProperty::Map& Map)
+		{
+			int32 NumProperties = 0;
+			Reader << NumProperties;
+
+			if (!IsValidCount(NumProperties))
+			{
+				return false;
+			}
+
+			Map.Reserve(NumProperties);
+
+			for (int32 Index = 0; Index < NumProperties; ++Index)
+			{
+				FName Key;
+				if (!ReadName(Key) || !ReadProperty(Map.Add(Key)))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+	private:
+		bool ReadProperty(FDeprecationProperty& Property)
+		{
+			if (!ReadName(Property.PropertyName)
+				|| !ReadName(Property.PropertyTypeName)
+				|| !ReadName(Property.StructTypeName)
+				|| !ReadName(Property.InnerTypeName)
+				|| !ReadName(Property.MapValueTypeName))
+			{
+				return false;
+			}
+
+			int32 NumKeys = 0;
+			Reader << NumKeys;
+
+			if (!IsValidCount(NumKeys))
+			{
+				return false;
+			}
+
+			Property.Keys.Reserve(NumKeys);
+			for (int32 Index = 0; Index < NumKeys; ++Index)
+			{
+				if (!ReadVariant(Property.AddKey()))
+				{
+					return false;
+				}
+			}
+
+			uint8 PackedValueType = 0;
+			Reader << PackedValueType;
+
+			if (PackedValueType != (uint8)EDeprecationVariantType::None)
+			{
+				const EDeprecationVariantType Type = (EDeprecationVariantType)PackedValueType;
+
+				int32 NumBytes = 0;
+				Reader << NumBytes;
+
+				if (!IsPackedType(Type) || !IsValidCount(NumBytes) || NumBytes % FDeprecationProperty::GetPackedSize(Type) != 0)
+				{
+					return false;
+				}
+
+				// Same layout as in memory, copied at once.
+				uint8* PackedValues = Property.AddPackedValues(Type, NumBytes / FDeprecationProperty::GetPackedSize(Type));
+				Reader.Serialize(PackedValues, NumBytes);
+
+				// Any byte but 0 and 1 would not be a valid bool.
+				if (Type == EDeprecationVariantType::Bool)
+				{
+					for (int32 Index = 0; Index < NumBytes; ++Index)
+					{
+						PackedValues[Index] = PackedValues[Index] != 0 ? 1 : 0;
+					}
+				}
+
+				return !Reader.IsError();
+			}
+
+			int32 NumValues = 0;
+			Reader << NumValues;
+
+			if (!IsValidCount(NumValues))
+			{
+				return false;
+			}
+
+			Property.Values.Reserve(NumValues);
+			for (int32 Index = 0; Index < NumValues; ++Index)
+			{
+				if (!ReadVariant(Property.AddValue()))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool ReadVariant(FDeprecationProperty::Variant& Variant)
+		{
+			uint8 Type = 0;
+			Reader << Type;
+
+			switch ((EDeprecationVariantType)Type)
+			{
+			case EDeprecationVariantType::None:
+				return !Reader.IsError();
+
+			case EDeprecationVariantType::Bool:
+				{
+					uint8 Value = 0;
+					Reader << Value;
+					Variant.Set(Value != 0);
+				}
+				return !Reader.IsError();
+
+#define RAW_TYPE(VariantType, CppType) \
+			case EDeprecationVariantType::VariantType: \
+				{ \
+					CppType Value; \
+					Reader.Serialize(&Value, sizeof(CppType)); \
+					Variant.Set(Value); \
+				} \
+				return !Reader.IsError();
+
+				DEPRECATION_RAW_VARIANT_TYPES(RAW_TYPE)
+
+#undef RAW_TYPE
+
+			case EDeprecationVariantType::Name:
+				{
+					FName Name;
+					if (!ReadName(Name))
+					{
+						return false;
+					}
+
+					Variant.Set(Name);
+				}
+				return true;
+
+			case EDeprecationVariantType::String:
+				if (!ReadString())
+				{
+					return false;
+				}
+
+				Variant.SetString(FStringView(Chars.GetData(), Chars.Num()));
+				return true;
+
+			case EDeprecationVariantType::SoftObjectPath:
+				if (!ReadString())
+				{
+					return false;
+				}
+
+				Variant.SetSoftObjectPath(FStringView(Chars.GetData(), Chars.Num()));
+				return true;
+
+			case EDeprecationVariantType::ObjectImport:
+				{
+					FObjectImport Import;
+					if (!ReadName(Import.ClassPackage) || !ReadName(Import.ClassName) || !ReadName(Import.ObjectName))
+					{
+						return false;
+					}
+
+					Reader << Import.OuterIndex;
+
+					if (!ReadString())
+					{
+						return false;
+					}
+
+					// Recorded again, so the import is resolved with the others before the handler runs.
+					Variant.Set(Import);
+					Tree.AddImport(Variant.GetObjectImport(), FSoftObjectPath(FString(Chars.Num(), Chars.GetData())));
+				}
+				return true;
+
+			case EDeprecationVariantType::Object:
+				{
+					int32 ExportIndex = INDEX_NONE;
+					Reader << ExportIndex;
+
+					if (ExportIndex == INDEX_NONE)
+					{
+						Variant.Set((UObject*)nullptr);
+					}
+					else if (Tables.Exports.IsValidIndex(ExportIndex))
+					{
+						Variant.Set(Tables.Exports[ExportIndex]);
+					}
+					else
+					{
+						return false;
+					}
+				}
+				return !Reader.IsError();
+
+			case EDeprecationVariantType::Properties:
+				{
+					FDeprecationProperty::Map* Properties = Tree.NewMap();
+					Variant.SetProperties(Properties);
+					return ReadMap(*Properties);
+				}
+
+			default:
+				return false;
+			}
+		}
+
+		bool ReadName(FName& OutName)
+		{
+			int32 NameIndex = INDEX_NONE;
+			Reader << NameIndex;
+
+			if (Reader.IsError() || !Names.IsValidIndex(NameIndex))
+			{
+				return false;
+			}
+
+			OutName = Names[NameIndex];
+			return true;
+		}
+
+		/**
+		 * Reads the characters of a string into Chars.
+		 */
+		bool ReadString()
+		{
+			int32 Len = 0;
+			Reader << Len;
+
+			if (!IsValidCount(Len))
+			{
+				return false;
+			}
+
+			Chars.SetNumUninitialized(Len, false);
+			Reader.Serialize(Chars.GetData(), Len * sizeof(TCHAR));
+			return !Reader.IsError();
+		}
+
+		/**
+		 * Checks a count read from the file against the bytes left, so a damaged file never allocates more than its size.
+		 */
+		bool IsValidCount(int32 Count)
+		{
+			return !Reader.IsError() && Count >= 0 && Count <= Reader.TotalSize() - Reader.Tell();
+		}
+
+	private:
+		FMemoryReader Reader;
+		const FDeprecationLinkerTables& Tables;
+		FDeprecationPropertyTree& Tree;
+
+		TArray<FName> Names;
+		TArray<TCHAR, TInlineAllocator<128>> Chars;
+	};
+}
+
+//------------------------
+bool FDeprecationTreeCache::IsEnabled()
+{
+#if UE_BUILD_SHIPPING
+	return false;
+#else
+	return CVarPersistentCache.GetValueOnAnyThread() != 0;
+#endif
+}
+
+//------------------------
+FString FDeprecationTreeCache::MakeKey(const FLinkerLoad& Linker, const UObject* Object, uint64 AssetVersion, uint64 CodeVersion)
+{
+	// Packages get a new guid every time they are saved, trees of their previous versions are never found again.
+	// The path of the object comes first, '|' can not be part of object names (see GetCacheFilePrefix).
+	return FString::Printf(TEXT("%s|%s|%s|%llu|%llu"), *Object->GetPathName(), *Linker.Summary.Guid.ToString(),
+		*Object->GetClass()->GetPathName(), AssetVersion, CodeVersion);
+}
+
+//------------------------
+bool FDeprecationTreeCache::Load(const FString& Key, const FDeprecationLinkerTables& Tables, FDeprecationPropertyTree& OutTree)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationTreeCache_Load);
+
+	const FString Path = GetCachePath(Key);
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	// Read into a tree of its own, so a damaged file leaves nothing behind.
+	FDeprecationPropertyTree Tree;
+	{
+		FDeprecationArena::FScope ArenaScope(Tree.GetArena());
+		FTreeReader Reader(Bytes, Tables, Tree);
+
+		if (!Reader.ReadHeader(Key))
+		{
+			return false;
+		}
+
+		if (!Reader.ReadMap(Tree.GetRoot()))
+		{
+			UE_LOG(LogClass, Warning, TEXT("Damaged deprecation cache file '%s' deleted: key '%s'"), *Path, *Key);
+			IFileManager::Get().Delete(*Path, false, false, true);
+			return false;
+		}
+	}
+
+	OutTree = MoveTemp(Tree);
+	return true;
+}
+
+//------------------------
+bool FDeprecationTreeCache::Save(const FString& Key, const FDeprecationLinkerTables& Tables, const FDeprecationPropertyTree& Tree)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(DeprecationTreeCache_Save);
+
+	FTreeWriter Writer(Tables, Tree);
+	if (!Writer.WriteMap(Tree.GetRoot()))
+	{
+		return false;
+	}
+
+	TArray<uint8> Bytes;
+	Writer.Finish(Key, Bytes);
+
+	// Only the tree is read here, the file is written by the thread pool instead of stalling the load.
+	Async(EAsyncExecution::ThreadPool, [Key, Bytes = MoveTemp(Bytes)]()
+	{
+		WriteCacheFile(Key, Bytes);
+	});
+
+	return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FDeprecationPropertyTree;
+class FLinkerLoad;
+struct FDeprecationLinkerTables;
+
+/**
+ * Local cache of the trees decoded for upgrades, one file per object in the saved directory of the project (DeprecationCache).
+ * Outdated assets are often loaded many times before being resaved: every load after the first reads its tree back
+ * from the cache instead of decoding the properties of the object again.
+ * Opt-in with Deprecation.PersistentCache, never enabled in shipping builds.
+ * Writing a tree deletes the previous ones of the object, files older than Deprecation.PersistentCacheMaxAgeDays are pruned once per session.
+ *
+ * Files hold a table of the names used by the tree, then its maps depth first. Packed values are stored as laid out in memory,
+ * copied back at once. Trees holding project structures (see DEPRECATION_BINARY_STRUCT) or objects which are not exports
+ * of their package are not cached, their values can not be written.
+ */
+class FDeprecationTreeCache final
+{
+	// Constructors
+public:
+	FDeprecationTreeCache() = delete;
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Returns whether or not trees should be read from and written to the cache.
+	 */
+	static bool IsEnabled();
+
+	/**
+	 * Builds the key of the tree of an object, unique to the saved package, the object and the versions of the upgrade.
+	 * @param Linker Linker loading the object.
+	 * @param Object Object being upgraded.
+	 * @param AssetVersion Version of the object in the package.
+	 * @param CodeVersion Version the object is upgraded to.
+	 * @returns Key of the tree.
+	 */
+	static FString MakeKey(const FLinkerLoad& Linker, const UObject* Object, uint64 AssetVersion, uint64 CodeVersion);
+
+	/**
+	 * Reads a tree from the cache, can be called from any thread.
+	 * @param Key Key of the tree, see MakeKey.
+	 * @param Tables Tables of the linker loading the object, to map its exports back to objects.
+	 * @param OutTree Receives the tree, left untouched if not found.
+	 * @returns True if the tree has been found, false otherwise.
+	 */
+	static bool Load(const FString& Key, const FDeprecationLinkerTables& Tables, FDeprecationPropertyTree& OutTree);
+
+	/**
+	 * Writes a tree to the cache, replacing the previous ones of the object. Can be called from any thread.
+	 * The tree is serialized right away, its file is written asynchronously.
+	 * @param Key Key of the tree, see MakeKey.
+	 * @param Tables Tables of the linker loading the object, to map objects to its exports.
+	 * @param Tree Tree to write.
+	 * @returns True if the file of the tree is being written, false if the tree can not be cached.
+	 */
+	static bool Save(const FString& Key, const FDeprecationLinkerTables& Tables, const FDeprecationPropertyTree& Tree);
+};
@@ -0,0 +1,339 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Linear allocator owning all the data decoded for a single deprecation scope.
+ * Memory is never freed individually, everything is released at once when the arena is reset or destroyed.
+ * Chunks start small and double up to a page, so the trees of small objects kept in queues and caches hold little memory.
+ * An arena must only be used by one thread at a time.
+ */
+class DEPRECATION_API FDeprecationArena final
+{
+	// Typedefs
+public:
+	/**
+	 * Makes an arena the current one for the calling thread, so containers using FDeprecationArenaAllocator allocate from it.
+	 */
+	class DEPRECATION_API FScope final
+	{
+	public:
+		FScope(FDeprecationArena& Arena);
+		~FScope();
+
+		FScope(const FScope& Other) = delete;
+		FScope& operator=(const FScope& Other) = delete;
+
+	private:
+		FDeprecationArena* PreviousArena;
+	};
+
+private:
+	/**
+	 * Destructor to run when the arena is released, for objects that are not trivially destructible.
+	 */
+	struct FDestructor
+	{
+		void (*Destruct)(void*);
+		void* Object;
+		FDestructor* Next;
+	};
+
+	/**
+	 * Header of a block of memory allocated from the heap, followed by its data.
+	 */
+	struct FChunk
+	{
+		FChunk* Next;
+		SIZE_T Size;
+	};
+
+
+
+
+	// Constructors
+public:
+	FDeprecationArena();
+	FDeprecationArena(const FDeprecationArena& Other) = delete;
+
+
+
+
+	// Destructor
+public:
+	~FDeprecationArena();
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Allocates uninitialized memory from the arena.
+	 * @param Size Size in bytes of the allocation.
+	 * @param Alignment Alignment of the allocation.
+	 * @returns Pointer to the allocated memory.
+	 */
+	inline void* Alloc(SIZE_T Size, SIZE_T Alignment)
+	{
+		++NumAllocations;
+		AllocatedSize += (int32)Size;
+
+		const UPTRINT Result = Align((UPTRINT)Top, FMath::Max<SIZE_T>(Alignment, 1));
+		if (!Top || Result + Size > (UPTRINT)End)
+		{
+			return AllocFromNewChunk(Size, Alignment);
+		}
+
+		Top = (uint8*)(Result + Size);
+		return (void*)Result;
+	}
+
+	/**
+	 * Constructs an object in the arena, its destructor will run when the arena is released.
+	 * @param Args Arguments forwarded to the constructor of the object.
+	 * @returns Newly constructed object.
+	 */
+	template <typename T, typename... ArgTypes>
+	inline T* New(ArgTypes&&... Args)
+	{
+		T* Object = new(Alloc(sizeof(T), alignof(T))) T(Forward<ArgTypes>(Args)...);
+
+		if (!TIsTriviallyDestructible<T>::Value)
+		{
+			FDestructor* Destructor = new(Alloc(sizeof(FDestructor), alignof(FDestructor))) FDestructor();
+			Destructor->Destruct = &Destruct<T>;
+			Destructor->Object = Object;
+			Destructor->Next = Destructors;
+			Destructors = Destructor;
+		}
+
+		return Object;
+	}
+
+	/**
+	 * Runs the registered destructors and releases all the memory of the arena.
+	 */
+	void Reset();
+
+	/**
+	 * Returns the arena of the calling thread, nullptr if none.
+	 */
+	static FDeprecationArena* GetCurrent();
+
+private:
+	/**
+	 * Allocates memory from a new chunk, the current one being too small.
+	 * @param Size Size in bytes of the allocation.
+	 * @param Alignment Alignment of the allocation.
+	 * @returns Pointer to the allocated memory.
+	 */
+	void* AllocFromNewChunk(SIZE_T Size, SIZE_T Alignment);
+
+	template <typename T>
+	static void Destruct(void* Object)
+	{
+		((T*)Object)->~T();
+	}
+
+
+
+
+	// Operators overload
+public:
+	FDeprecationArena& operator=(const FDeprecationArena& Other) = delete;
+
+
+
+
+	// Properties
+public:
+	/**
+	 * Returns the number of bytes allocated from the arena.
+	 */
+	inline int32 GetAllocatedSize() const
+	{
+		return AllocatedSize;
+	}
+
+	/**
+	 * Returns the number of allocations made from the arena.
+	 */
+	inline int32 GetNumAllocations() const
+	{
+		return NumAllocations;
+	}
+
+	/**
+	 * Returns the number of bytes allocated by all the arenas released so far, by any thread.
+	 */
+	static uint64 GetTotalAllocatedSize();
+
+	/**
+	 * Returns the number of allocations made by all the arenas released so far, by any thread.
+	 */
+	static uint64 GetTotalNumAllocations();
+
+
+
+
+	// Fields
+private:
+	FChunk* Chunks;
+	uint8* Top;
+	uint8* End;
+
+	FDestructor* Destructors;
+	int32 AllocatedSize;
+	int32 NumAllocations;
+};
+
+/**
+ * Container allocator taking its memory from the current deprecation arena.
+ * The arena is captured on first allocation, containers created outside of an arena scope fall back to the heap.
+ */
+class FDeprecationArenaAllocator
+{
+public:
+	using SizeType = int32;
+
+	enum { NeedsElementType = false };
+	enum { RequireRangeCheck = true };
+
+	/** Alignment of arena allocations, the one of heap allocations: elements can be vector types. */
+	enum { Alignment = 16 };
+
+	class ForAnyElementType
+	{
+	public:
+		ForAnyElementType()
+			: Data(nullptr)
+			, Arena(nullptr)
+		{ }
+
+		FORCEINLINE ~ForAnyElementType()
+		{
+			FreeHeapData();
+		}
+
+		FORCEINLINE void MoveToEmpty(ForAnyElementType& Other)
+		{
+			checkSlow(this != &Other);
+
+			FreeHeapData();
+
+			Data = Other.Data;
+			Arena = Other.Arena;
+
+			Other.Data = nullptr;
+			Other.Arena = nullptr;
+		}
+
+		FORCEINLINE FScriptContainerElement* GetAllocation() const
+		{
+			return Data;
+		}
+
+		void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement)
+		{
+			if (!Data)
+			{
+				Arena = FDeprecationArena::GetCurrent();
+			}
+
+			if (!Arena)
+			{
+				if (Data || NumElements)
+				{
+					Data = (FScriptContainerElement*)FMemory::Realloc(Data, NumElements * NumBytesPerElement);
+				}
+				return;
+			}
+
+			// Arena memory is only released with the arena, growing leaves the previous block behind.
+			FScriptContainerElement* NewData = nullptr;
+			if (NumElements)
+			{
+				NewData = (FScriptContainerElement*)Arena->Alloc(NumElements * NumBytesPerElement, Alignment);
+				if (Data && PreviousNumElements)
+				{
+					FMemory::Memcpy(NewData, Data, FMath::Min(PreviousNumElements, NumElements) * NumBytesPerElement);
+				}
+			}
+			Data = NewData;
+		}
+
+		FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false);
+		}
+
+		FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false);
+		}
+
+		FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false);
+		}
+
+		FORCEINLINE SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return NumAllocatedElements * NumBytesPerElement;
+		}
+
+		FORCEINLINE bool HasAllocation() const
+		{
+			return !!Data;
+		}
+
+		FORCEINLINE SizeType GetInitialCapacity() const
+		{
+			return 0;
+		}
+
+	private:
+		ForAnyElementType(const ForAnyElementType&) = delete;
+		ForAnyElementType& operator=(const ForAnyElementType&) = delete;
+
+		FORCEINLINE void FreeHeapData()
+		{
+			if (Data && !Arena)
+			{
+				FMemory::Free(Data);
+			}
+		}
+
+		FScriptContainerElement* Data;
+		FDeprecationArena* Arena;
+	};
+
+	template <typename ElementType>
+	class ForElementType : public ForAnyElementType
+	{
+	public:
+		ForElementType()
+		{ }
+
+		FORCEINLINE ElementType* GetAllocation() const
+		{
+			return (ElementType*)ForAnyElementType::GetAllocation();
+		}
+	};
+};
+
+template <>
+struct TAllocatorTraits<FDeprecationArenaAllocator> : TAllocatorTraitsBase<FDeprecationArenaAllocator>
+{
+	enum { SupportsMove = true };
+	enum { IsZeroConstruct = true };
+};
+
+/**
+ * Set allocator taking all its memory (elements, bit array and hash) from the current deprecation arena.
+ */
+typedef TSetAllocator<
+	TSparseArrayAllocator<FDeprecationArenaAllocator, TInlineAllocator<4, FDeprecationArenaAllocator>>,
+	TInlineAllocator<1, FDeprecationArenaAllocator>
+> FDeprecationArenaSetAllocator;
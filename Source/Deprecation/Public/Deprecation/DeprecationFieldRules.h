@@ -0,0 +1,143 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Declarative upgrades of a class: properties renamed, widened or moved into a structure at a given version.
+ * Rules are applied by the scope straight from the archive into the properties of the object,
+ * no property map is decoded and no handler has to be written for them.
+ * Rules of successive versions are chained, a property renamed twice is found under its latest name.
+ */
+class DEPRECATION_API FDeprecationFieldRules final
+{
+	// Typedefs
+public:
+	/**
+	 * Single rule, mapping the path of a property before a version to its path from that version on.
+	 */
+	struct FRule
+	{
+		/** Version introducing the rule, applied to assets saved with an older version. */
+		uint64 Version;
+
+		/** Path of the property before the rule (e.g. "Health"). */
+		FName OldPath;
+
+		/** Path of the property from the rule on, dot separated to move it into structures (e.g. "Stats.Health"). */
+		FName NewPath;
+	};
+
+	typedef UClass* (*ClassGetter)();
+	typedef void (*RegisterFunction)(FDeprecationFieldRules& Rules);
+
+	/**
+	 * Registers the rules of a class at static initialization time, see DEPRECATION_FIELD_RULES.
+	 */
+	struct DEPRECATION_API FRegistrar
+	{
+		/**
+		 * @param GetClass Function returning the class of the rules (StaticClass), only called once UObjects are initialized.
+		 * @param VersionPropertyName Name of the property holding the deprecation version the rules refer to.
+		 * @param Register Function adding the rules.
+		 */
+		FRegistrar(ClassGetter GetClass, const TCHAR* VersionPropertyName, RegisterFunction Register);
+	};
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Renames a property, its value is converted if its type has changed too.
+	 * @param Version Version introducing the new name.
+	 * @param OldName Name of the property before the version.
+	 * @param NewName Name of the property from the version on.
+	 */
+	FDeprecationFieldRules& Rename(uint64 Version, FName OldName, FName NewName);
+
+	/**
+	 * Converts the value of a property whose numeric type has been widened (e.g. int32 to int64, float to double).
+	 * @param Version Version introducing the new type.
+	 * @param Name Name of the property.
+	 */
+	FDeprecationFieldRules& Widen(uint64 Version, FName Name);
+
+	/**
+	 * Moves a property into a structure property of the class.
+	 * @param Version Version introducing the structure.
+	 * @param OldName Name of the property before the version.
+	 * @param NewPath Path of the property in the structure from the version on (e.g. "Transform.Location").
+	 */
+	FDeprecationFieldRules& MoveToStruct(uint64 Version, FName OldName, FName NewPath);
+
+	/**
+	 * Follows the rules from the version of an asset to the version of the code.
+	 * @param OldPath Path of the property in the asset.
+	 * @param AssetVersion Version of the asset.
+	 * @param CodeVersion Version of the code.
+	 * @returns Path of the property in the code, NAME_None if no rule applies to it.
+	 */
+	FName MapPath(FName OldPath, uint64 AssetVersion, uint64 CodeVersion) const;
+
+	/**
+	 * Sorts the rules by version, keeping the order of registration within a version.
+	 */
+	void Sort();
+
+private:
+	FDeprecationFieldRules& AddRule(uint64 Version, FName OldPath, FName NewPath);
+
+
+
+
+	// Properties
+public:
+	/**
+	 * Returns the rules, sorted by version once registered.
+	 */
+	inline const TArray<FRule>& GetRules() const
+	{
+		return Rules;
+	}
+
+	/**
+	 * Returns whether or not there is at least one rule.
+	 */
+	inline bool IsEmpty() const
+	{
+		return Rules.Num() == 0;
+	}
+
+
+
+
+	// Fields
+private:
+	TArray<FRule> Rules;
+};
+
+/**
+ * Declares the field rules of a class, in a source file. The body receives the rules to fill as Rules:
+ *
+ * DEPRECATION_FIELD_RULES(UMyObject)
+ * {
+ *     Rules.Rename(2, TEXT("Hp"), TEXT("Health"));
+ *     Rules.MoveToStruct(3, TEXT("Location"), TEXT("Transform.Location"));
+ * }
+ *
+ * Objects of the class apply them through a DEPRECATION_SCOPE_RULES scope (or any scope, before their handler).
+ * @param ClassName Class of the rules, the rules also apply to its child classes.
+ */
+#define DEPRECATION_FIELD_RULES(ClassName) DEPRECATION_FIELD_RULES_CUSTOM_VERSION_PROPERTY(ClassName, DeprecationVersion)
+
+/**
+ * Declares the field rules of a class, for the given version property.
+ * @param ClassName Class of the rules, the rules also apply to its child classes.
+ * @param VersionPropertyName Name of the property holding the deprecation version, as an identifier.
+ */
+#define DEPRECATION_FIELD_RULES_CUSTOM_VERSION_PROPERTY(ClassName, VersionPropertyName) \
+	static void DeprecationFieldRules_##ClassName##_##VersionPropertyName(FDeprecationFieldRules& Rules); \
+	static const FDeprecationFieldRules::FRegistrar DeprecationFieldRulesRegistrar_##ClassName##_##VersionPropertyName( \
+		&ClassName::StaticClass, TEXT(#VersionPropertyName), &DeprecationFieldRules_##ClassName##_##VersionPropertyName); \
+	static void DeprecationFieldRules_##ClassName##_##VersionPropertyName(FDeprecationFieldRules& Rules)
@@ -9,4 +9,6 @@
 class DEPRECATION_API FDeprecationModule : public IModuleInterface
 {
 public:
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
 };
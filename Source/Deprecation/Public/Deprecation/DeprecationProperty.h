@@ -1,9 +1,156 @@
-
-
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/StringView.h"
+#include "Templates/ChooseClass.h"
 #include "UObject/ObjectResource.h"
+#include "UObject/SoftObjectPath.h"
+
+#include "Deprecation/DeprecationArena.h"
+
+/**
+ * Type of the data held by a deprecation property variant.
+ */
+enum class EDeprecationVariantType : uint8
+{
+	None,
+
+	Bool,
+
+	Int8,
+	Int16,
+	Int32,
+	Int64,
+	UInt8,
+	UInt16,
+	UInt32,
+	UInt64,
+
+	Float,
+	Double,
+
+	Name,
+	String,
+	SoftObjectPath,
+
+	Box,
+	Box2D,
+	Vector2D,
+	IntRect,
+	IntPoint,
+	Vector4,
+	Vector,
+	Rotator,
+	Color,
+	Plane,
+	Matrix,
+	LinearColor,
+	Quat,
+	Transform,
+	Sphere,
+	BoxSphereBounds,
+
+	/** Project structure, see FDeprecationProperty::Variant::SetStruct. */
+	Struct,
+
+	ObjectImport,
+	Object,
+	Properties,
+};
+
+/**
+ * Associates a C++ type with the variant type used to store it.
+ */
+template <typename T>
+struct TDeprecationVariantTraits
+{
+	static constexpr EDeprecationVariantType Type = EDeprecationVariantType::None;
+};
+
+#define DEPRECATION_VARIANT_TYPE(CppType, VariantType) \
+	template <> \
+	struct TDeprecationVariantTraits<CppType> \
+	{ \
+		static constexpr EDeprecationVariantType Type = EDeprecationVariantType::VariantType; \
+	}
+
+DEPRECATION_VARIANT_TYPE(bool, Bool);
+DEPRECATION_VARIANT_TYPE(int8, Int8);
+DEPRECATION_VARIANT_TYPE(int16, Int16);
+DEPRECATION_VARIANT_TYPE(int32, Int32);
+DEPRECATION_VARIANT_TYPE(int64, Int64);
+DEPRECATION_VARIANT_TYPE(uint8, UInt8);
+DEPRECATION_VARIANT_TYPE(uint16, UInt16);
+DEPRECATION_VARIANT_TYPE(uint32, UInt32);
+DEPRECATION_VARIANT_TYPE(uint64, UInt64);
+DEPRECATION_VARIANT_TYPE(float, Float);
+DEPRECATION_VARIANT_TYPE(double, Double);
+DEPRECATION_VARIANT_TYPE(FName, Name);
+DEPRECATION_VARIANT_TYPE(FBox, Box);
+DEPRECATION_VARIANT_TYPE(FBox2D, Box2D);
+DEPRECATION_VARIANT_TYPE(FVector2D, Vector2D);
+DEPRECATION_VARIANT_TYPE(FIntRect, IntRect);
+DEPRECATION_VARIANT_TYPE(FIntPoint, IntPoint);
+DEPRECATION_VARIANT_TYPE(FVector4, Vector4);
+DEPRECATION_VARIANT_TYPE(FVector, Vector);
+DEPRECATION_VARIANT_TYPE(FRotator, Rotator);
+DEPRECATION_VARIANT_TYPE(FColor, Color);
+DEPRECATION_VARIANT_TYPE(FPlane, Plane);
+DEPRECATION_VARIANT_TYPE(FMatrix, Matrix);
+DEPRECATION_VARIANT_TYPE(FLinearColor, LinearColor);
+DEPRECATION_VARIANT_TYPE(FQuat, Quat);
+DEPRECATION_VARIANT_TYPE(FTransform, Transform);
+DEPRECATION_VARIANT_TYPE(FSphere, Sphere);
+DEPRECATION_VARIANT_TYPE(FBoxSphereBounds, BoxSphereBounds);
+DEPRECATION_VARIANT_TYPE(FObjectImport, ObjectImport);
+DEPRECATION_VARIANT_TYPE(UObject*, Object);
+
+/**
+ * Operations on a project structure held by a variant, whose type is only known by the code reading it.
+ * Structures are destroyed by their variant: Delete when it owns them, Destruct when their memory belongs to an arena.
+ */
+struct FDeprecationStructOps
+{
+	void* (*Copy)(const void* Data, bool& bOutOwnsPayload);
+	void (*Delete)(void* Data);
+	void (*Destruct)(void* Data);
+};
+
+/**
+ * Operations of a given project structure, their address identifies the type held by a variant.
+ */
+template <typename T>
+struct TDeprecationStructOps
+{
+	static const FDeprecationStructOps* Get()
+	{
+		static const FDeprecationStructOps Ops = { &Copy, &Delete, &Destruct };
+		return &Ops;
+	}
+
+	static void* Copy(const void* Data, bool& bOutOwnsPayload)
+	{
+		// Constructed in place rather than with FDeprecationArena::New, the variant runs the destructor itself.
+		if (FDeprecationArena* Arena = FDeprecationArena::GetCurrent())
+		{
+			bOutOwnsPayload = false;
+			return new(Arena->Alloc(sizeof(T), alignof(T))) T(*(const T*)Data);
+		}
+
+		bOutOwnsPayload = true;
+		return new T(*(const T*)Data);
+	}
+
+	static void Delete(void* Data)
+	{
+		delete (T*)Data;
+	}
+
+	static void Destruct(void* Data)
+	{
+		((T*)Data)->~T();
+	}
+};
 
 /**
  * Property describing the data retrieved directly from the asset file.
@@ -20,162 +167,356 @@ private:
 public:
 	/**
 	 * Property map, with the key being the name of the property.
+	 * Allocates from the arena of the tree decoding it, properties are move-only.
 	 */
-	typedef TMap<FName, FDeprecationProperty> Map;
+	typedef TMap<FName, FDeprecationProperty, FDeprecationArenaSetAllocator> Map;
 
 	/**
-	 * Union representing all type of data that can be held by a property.
+	 * Compact value holding any type of data a property can have.
+	 * Types up to InlineSize bytes are stored in place, larger ones are stored out of line,
+	 * in the current arena if any (released with it), on the heap otherwise (owned by the variant).
+	 * The active type is recorded so reads can be validated.
 	 */
-	typedef union Variant
+	class Variant
 	{
+		// Constants
+	public:
+		static constexpr int32 InlineSize = 16;
+
+		/**
+		 * Whether or not values of the given type are stored in place.
+		 */
+		template <typename T>
+		struct TIsInline
+		{
+			enum { Value = sizeof(T) <= InlineSize };
+		};
+
+
+
+
+		// Constructors
+	public:
 		Variant()
-			: Name()
-			, Box()
-			, Box2D()
-			, Vector2D()
-			, IntRect()
-			, IntPoint()
-			, Vector4()
-			, Vector()
-			, Rotator()
-			, Color()
-			, Plane()
-			, Matrix()
-			, LinearColor()
-			, Quat()
-			, Transform()
-			, ObjectImport()
-		{ 
-			FMemory::Memset(this, 0, sizeof(Variant));
+			: Type(EDeprecationVariantType::None)
+			, bOwnsPayload(false)
+		{
+			FMemory::Memzero(Storage);
 		}
 
 		Variant(const Variant& Other)
-			: bBool(Other.bBool)
-			, Int8(Other.Int8)
-			, Int16(Other.Int16)
-			, Int32(Other.Int32)
-			, Int64(Other.Int64)
-			, UInt8(Other.UInt8)
-			, UInt16(Other.UInt16)
-			, UInt32(Other.UInt32)
-			, UInt64(Other.UInt64)
-			, Float(Other.Float)
-			, Double(Other.Double)
-			, Name(Other.Name)
-			, Box(Other.Box)
-			, Box2D(Other.Box2D)
-			, Vector2D(Other.Vector2D)
-			, IntRect(Other.IntRect)
-			, IntPoint(Other.IntPoint)
-			, Vector4(Other.Vector4)
-			, Vector(Other.Vector)
-			, Rotator(Other.Rotator)
-			, Color(Other.Color)
-			, Plane(Other.Plane)
-			, Matrix(Other.Matrix)
-			, LinearColor(Other.LinearColor)
-			, Quat(Other.Quat)
-			, Transform(Other.Transform)
-			, ObjectImport(Other.ObjectImport)
-			, XObject(Other.XObject)
-			, Properties(Other.Properties)
-		{
-			FMemory::Memcpy(*this, Other);
+			: Type(EDeprecationVariantType::None)
+			, bOwnsPayload(false)
+		{
+			*this = Other;
 		}
 
-		Variant& operator=(const Variant& Other)
+		Variant(Variant&& Other)
+			: Type(EDeprecationVariantType::None)
+			, bOwnsPayload(false)
 		{
-			FMemory::Memcpy(*this, Other);
+			*this = MoveTemp(Other);
+		}
+
+
+
+
+		// Destructor
+	public:
+		~Variant()
+		{
+			Reset();
+		}
+
+
+
+
+		// Methods
+	public:
+		/**
+		 * Checks if the variant holds a value of the given type.
+		 */
+		template <typename T>
+		inline bool IsType() const
+		{
+			return Type == TDeprecationVariantTraits<T>::Type;
+		}
+
+		/**
+		 * Retrieves the value held by the variant.
+		 * Small types are returned by value, large ones by reference.
+		 * @param <T> Type of the value, must match the type held by the variant.
+		 * @returns The value held by the variant.
+		 */
+		template <typename T>
+		inline typename TChooseClass<TIsInline<T>::Value, T, const T&>::Result Get() const
+		{
+			static_assert(TDeprecationVariantTraits<T>::Type != EDeprecationVariantType::None, "Type can not be stored in a deprecation variant.");
+			checkf(IsType<T>(), TEXT("Variant holds type %d, not %d."), (int32)Type, (int32)TDeprecationVariantTraits<T>::Type);
+			return GetUnchecked<T>(typename TChooseClass<TIsInline<T>::Value, FInlineTag, FOutOfLineTag>::Result());
+		}
+
+		/**
+		 * Stores a value in the variant, replacing the previous one.
+		 * @param Value Value to store.
+		 */
+		template <typename T>
+		inline void Set(const T& Value)
+		{
+			static_assert(TDeprecationVariantTraits<T>::Type != EDeprecationVariantType::None, "Type can not be stored in a deprecation variant.");
+
+			Reset();
+			SetUnchecked(Value, typename TChooseClass<TIsInline<T>::Value, FInlineTag, FOutOfLineTag>::Result());
+			Type = TDeprecationVariantTraits<T>::Type;
+		}
+
+		/**
+		 * Returns a view on the characters of a string or soft object path.
+		 * The view is valid as long as the variant (or the tree holding it) is.
+		 */
+		inline FStringView GetStringView() const
+		{
+			check(Type == EDeprecationVariantType::String || Type == EDeprecationVariantType::SoftObjectPath);
+			const FStringPayload StringPayload = GetUnchecked<FStringPayload>(FInlineTag());
+			return FStringView(StringPayload.Data, StringPayload.Len);
 		}
 
 		inline FString GetString() const
 		{
-			return Name.GetPlainNameString();
+			const FStringView View = GetStringView();
+			return FString(View.Len(), View.GetData());
 		}
 
-		inline void SetString(FString Value)
+		/**
+		 * Stores a copy of a string, in the current arena if any, on the heap otherwise.
+		 * Strings are never added to the name table.
+		 */
+		inline void SetString(FStringView Value)
 		{
-			Name = FName(*Value);
+			SetStringUnchecked(Value, EDeprecationVariantType::String);
 		}
 
-		bool				bBool;
+		/**
+		 * Builds a soft object path, only then are its names added to the name table.
+		 */
+		inline FSoftObjectPath GetSoftObjectPath() const
+		{
+			check(Type == EDeprecationVariantType::SoftObjectPath);
+			return FSoftObjectPath(GetString());
+		}
 
-		int8				Int8;
-		int16				Int16;
-		int32				Int32;
-		int64				Int64;
-		uint8				UInt8;
-		uint16				UInt16;
-		uint32				UInt32;
-		uint64				UInt64;
+		inline void SetSoftObjectPath(FStringView Value)
+		{
+			SetStringUnchecked(Value, EDeprecationVariantType::SoftObjectPath);
+		}
 
-		float				Float;
-		double				Double;
+		/**
+		 * Returns the import held by the variant, so its object can be filled once resolved.
+		 */
+		inline FObjectImport& GetObjectImport()
+		{
+			check(Type == EDeprecationVariantType::ObjectImport);
+			return *(FObjectImport*)Payload;
+		}
 
-		FName				Name;
+		/**
+		 * Returns the project structure held by the variant (see DEPRECATION_BINARY_STRUCT).
+		 * @param <T> Type of the structure.
+		 * @returns The structure, nullptr if the variant holds another type.
+		 */
+		template <typename T>
+		inline const T* GetStruct() const
+		{
+			if (Type != EDeprecationVariantType::Struct)
+			{
+				return nullptr;
+			}
 
-		FBox				Box;
-		FBox2D				Box2D;
-		FVector2D			Vector2D;
-		FIntRect			IntRect;
-		FIntPoint			IntPoint;
-		FVector4			Vector4;
-		FVector				Vector;
-		FRotator			Rotator;
-		FColor				Color;
-		FPlane				Plane;
-		FMatrix				Matrix;
-		FLinearColor		LinearColor;
-		FQuat				Quat;
-		FTransform			Transform;
+			const FStructPayload StructPayload = GetUnchecked<FStructPayload>(FInlineTag());
+			return StructPayload.Ops == TDeprecationStructOps<T>::Get() ? (const T*)StructPayload.Data : nullptr;
+		}
 
-		FObjectImport		ObjectImport;
-		UObject*			XObject;
-		Map*				Properties;
-	} Variant;
+		/**
+		 * Stores a copy of a project structure, always out of line, in the current arena if any, on the heap otherwise.
+		 */
+		template <typename T>
+		inline void SetStruct(const T& Value)
+		{
+			SetStructUnchecked(&Value, TDeprecationStructOps<T>::Get());
+		}
 
+		/**
+		 * Returns the nested map of a structure property.
+		 * Nested maps are owned by their FDeprecationPropertyTree, variants only reference them.
+		 */
+		inline Map* GetProperties() const
+		{
+			check(Type == EDeprecationVariantType::Properties);
+			return GetUnchecked<Map*>(FInlineTag());
+		}
 
+		inline void SetProperties(Map* Properties)
+		{
+			Reset();
+			SetUnchecked(Properties, FInlineTag());
+			Type = EDeprecationVariantType::Properties;
+		}
 
+		/**
+		 * Releases the value held by the variant.
+		 */
+		void Reset();
 
-	// Constructors
-public:
-	FDeprecationProperty()
-		: bHasKeyProperties(false)
-		, bHasValueProperties(false)
-	{ }
+	private:
+		struct FInlineTag {};
+		struct FOutOfLineTag {};
 
+		struct FStringPayload
+		{
+			TCHAR* Data;
+			int32 Len;
+		};
 
+		struct FStructPayload
+		{
+			void* Data;
+			const FDeprecationStructOps* Ops;
+		};
 
+		void SetStringUnchecked(FStringView Value, EDeprecationVariantType StringType);
+		void SetStructUnchecked(const void* Data, const FDeprecationStructOps* Ops);
 
-	// Destructor
-public:
-	~FDeprecationProperty()
-	{
-		if (bHasKeyProperties)
+		template <typename T>
+		inline T GetUnchecked(FInlineTag) const
 		{
-			for (Variant& Variant : Keys)
-			{
-				delete Variant.Properties;
-				Variant.Properties = nullptr;
-			}
-			bHasKeyProperties = false;
+			// Copying out, storage is not aligned for vector types.
+			T Value;
+			FMemory::Memcpy(&Value, Storage, sizeof(T));
+			return Value;
+		}
+
+		template <typename T>
+		inline const T& GetUnchecked(FOutOfLineTag) const
+		{
+			return *(const T*)Payload;
 		}
 
-		if (bHasValueProperties)
+		template <typename T>
+		inline void SetUnchecked(const T& Value, FInlineTag)
 		{
-			for (Variant& Variant : Values)
+			FMemory::Memcpy(Storage, &Value, sizeof(T));
+		}
+
+		template <typename T>
+		inline void SetUnchecked(const T& Value, FOutOfLineTag)
+		{
+			if (FDeprecationArena* Arena = FDeprecationArena::GetCurrent())
+			{
+				Payload = Arena->New<T>(Value);
+				bOwnsPayload = false;
+			}
+			else
 			{
-				delete Variant.Properties;
-				Variant.Properties = nullptr;
+				Payload = new T(Value);
+				bOwnsPayload = true;
 			}
-			bHasKeyProperties = false;
 		}
-	}
 
 
 
 
-	
+		// Operators overload
+	public:
+		Variant& operator=(const Variant& Other);
+		Variant& operator=(Variant&& Other);
+
+
+
+
+		// Properties
+	public:
+		/**
+		 * Returns the type of the value held by the variant.
+		 */
+		inline EDeprecationVariantType GetType() const
+		{
+			return Type;
+		}
+
+
+
+
+		// Fields
+	private:
+		union
+		{
+			uint8 Storage[InlineSize];
+			void* Payload;
+			uint64 Alignment;
+		};
+
+		EDeprecationVariantType Type;
+		bool bOwnsPayload;
+	};
+
+
+
+
+	/**
+	 * Non-owning range over the values of a property, reading them with GetValueAs.
+	 * @param <T> Type of the values.
+	 */
+	template <typename T>
+	class TValueRange final
+	{
+	public:
+		class FIterator final
+		{
+		public:
+			FIterator(const FDeprecationProperty& Property, int32 Index)
+				: Property(&Property)
+				, Index(Index)
+			{ }
+
+			inline T operator*() const { return Property->GetValueAs<T>(Index); }
+			inline FIterator& operator++() { ++Index; return *this; }
+			inline bool operator!=(const FIterator& Other) const { return Index != Other.Index; }
+
+		private:
+			const FDeprecationProperty* Property;
+			int32 Index;
+		};
+
+		explicit TValueRange(const FDeprecationProperty& Property)
+			: Property(Property)
+		{ }
+
+		inline FIterator begin() const { return FIterator(Property, 0); }
+		inline FIterator end() const { return FIterator(Property, Num()); }
+
+		inline T operator[](int32 Index) const { return Property.GetValueAs<T>(Index); }
+		inline int32 Num() const { return Property.NumValues(); }
+
+	private:
+		const FDeprecationProperty& Property;
+	};
+
+
+
+
+	// Constructors
+public:
+	FDeprecationProperty()
+		: PackedValueType(EDeprecationVariantType::None)
+	{ }
+
+	FDeprecationProperty(FDeprecationProperty&& Other) = default;
+	FDeprecationProperty(const FDeprecationProperty& Other) = delete;
+
+
+
+
+
 	// Methods
 public:
 	/**
@@ -208,23 +549,79 @@ public:
 
 	/**
 	 * Retrieves a value with the given index.
+	 * Packed values have no variant, they are read through GetValueAs or GetPackedValues.
 	 * @param Index Index in the array of values to retrieve.
 	 * @returns A variant holding value data.
 	 */
 	inline const Variant& GetValue(int32 Index) const
 	{
+		check(!IsPacked());
 		return Values[Index];
 	}
 
 	/**
-	 * Retrieves the first key in the array of keys.
-	 * @returns A variant holding key data.
+	 * Retrieves the first value in the array of values.
+	 * @returns A variant holding value data.
 	 */
 	inline const Variant& GetValue() const
 	{
 		return GetValue(0);
 	}
 
+	/**
+	 * Retrieves a value with the given index, without going through a variant.
+	 * @param <T> Type of the value, must match the stored type.
+	 * @param Index Index in the array of values to retrieve.
+	 * @returns The value.
+	 */
+	template <typename T>
+	inline T GetValueAs(int32 Index) const
+	{
+		if (IsPacked())
+		{
+			check(PackedValueType == TDeprecationVariantTraits<T>::Type);
+			return GetPackedValues<T>()[Index];
+		}
+
+		return Values[Index].Get<T>();
+	}
+
+	/**
+	 * Retrieves a value with the given index if it has the requested type, never asserts.
+	 * @param <T> Type of the value, checked against the stored type.
+	 * @param Index Index in the array of values to retrieve.
+	 * @param OutValue Receives the value.
+	 * @returns True if the value exists with the requested type, false otherwise.
+	 */
+	template <typename T>
+	inline bool TryGetValueAs(int32 Index, T& OutValue) const
+	{
+		if (Index < 0 || Index >= NumValues())
+		{
+			return false;
+		}
+
+		if (IsPacked())
+		{
+			if (PackedValueType != TDeprecationVariantTraits<T>::Type)
+			{
+				return false;
+			}
+
+			OutValue = GetPackedValues<T>()[Index];
+			return true;
+		}
+
+		const Variant& Value = Values[Index];
+		if (!Value.IsType<T>())
+		{
+			return false;
+		}
+
+		OutValue = Value.Get<T>();
+		return true;
+	}
+
 	/**
 	 * Adds a value in the array of property values.
 	 * @returns Newly created variant holding value data.
@@ -234,27 +631,146 @@ public:
 		return Values.AddDefaulted_GetRef();
 	}
 
+	/**
+	 * Adds uninitialized values in the packed buffer of property values.
+	 * @param Type Type of the values, all the packed values must have the same type.
+	 * @param Count Number of values to add.
+	 * @returns Pointer to the first added value.
+	 */
+	inline uint8* AddPackedValues(EDeprecationVariantType Type, int32 Count)
+	{
+		check(PackedValueType == EDeprecationVariantType::None || PackedValueType == Type);
+		PackedValueType = Type;
+
+		const int32 Offset = PackedValues.AddUninitialized(Count * GetPackedSize(Type));
+		return PackedValues.GetData() + Offset;
+	}
+
 	/**
 	 * Returns whether or not there is at least one value.
 	 */
-	inline bool HasValue() const { return Values.Num() > 0; }
+	inline bool HasValue() const { return NumValues() > 0; }
+
+	/**
+	 * Returns the number of values (for an array or a map property).
+	 */
+	inline int32 NumValues() const
+	{
+		return IsPacked() ? PackedValues.Num() / GetPackedSize(PackedValueType) : Values.Num();
+	}
+
+	/**
+	 * Returns whether or not the values are stored in a contiguous typed buffer (for arrays and sets of primitives, arrays of math structures).
+	 */
+	inline bool IsPacked() const
+	{
+		return PackedValueType != EDeprecationVariantType::None;
+	}
+
+	/**
+	 * Returns the packed values associated with this property (for an array or a set of primitives, an array of math structures).
+	 * @param <T> Type of the values, must match the packed type.
+	 */
+	template <typename T>
+	inline TArrayView<const T> GetPackedValues() const
+	{
+		check(PackedValueType == TDeprecationVariantTraits<T>::Type);
+		return TArrayView<const T>((const T*)PackedValues.GetData(), NumValues());
+	}
+
+	/**
+	 * Copies the packed numbers converted to another numeric type, e.g. float to double when a property has been widened.
+	 * @param <T> Numeric type of the copied values.
+	 * @param OutValues Receives the converted values.
+	 * @returns True if the values are packed numbers, false otherwise.
+	 */
+	template <typename T>
+	bool ConvertPackedValues(TArray<T>& OutValues) const
+	{
+		static_assert(TIsArithmetic<T>::Value, "Packed values can only be converted to numbers.");
+
+		switch (PackedValueType)
+		{
+		case EDeprecationVariantType::Int8:		ConvertValues<int8>(OutValues); return true;
+		case EDeprecationVariantType::Int16:	ConvertValues<int16>(OutValues); return true;
+		case EDeprecationVariantType::Int32:	ConvertValues<int32>(OutValues); return true;
+		case EDeprecationVariantType::Int64:	ConvertValues<int64>(OutValues); return true;
+		case EDeprecationVariantType::UInt8:	ConvertValues<uint8>(OutValues); return true;
+		case EDeprecationVariantType::UInt16:	ConvertValues<uint16>(OutValues); return true;
+		case EDeprecationVariantType::UInt32:	ConvertValues<uint32>(OutValues); return true;
+		case EDeprecationVariantType::UInt64:	ConvertValues<uint64>(OutValues); return true;
+		case EDeprecationVariantType::Float:	ConvertValues<float>(OutValues); return true;
+		case EDeprecationVariantType::Double:	ConvertValues<double>(OutValues); return true;
+		default: return false;
+		}
+	}
 
 	/**
 	 * Returns all the keys associated with this property (for a map property).
 	 */
-	inline const TArray<Variant> GetKeys() const
+	inline TArrayView<const Variant> GetKeys() const
 	{
 		return Keys;
 	}
-	
+
 	/**
-	 * Returns all the values associated with this property. (for an array or a map property).
+	 * Returns all the values associated with this property (for an array or a map property).
+	 * Packed values have no variants, they are read through GetValuesAs, GetPackedValues or ConvertPackedValues.
 	 */
-	inline const TArray<Variant> GetValues() const
+	inline TArrayView<const Variant> GetValues() const
 	{
+		check(!IsPacked());
 		return Values;
 	}
 
+	/**
+	 * Returns a typed view over all the values associated with this property, packed or not.
+	 * @param <T> Type of the values, must match the stored type.
+	 */
+	template <typename T>
+	inline TValueRange<T> GetValuesAs() const
+	{
+		return TValueRange<T>(*this);
+	}
+
+	/**
+	 * Returns the size in bytes of a packed value of the given type.
+	 * @param Type Type of the packed value, must be a primitive type or a math structure laid out as serialized.
+	 */
+	static int32 GetPackedSize(EDeprecationVariantType Type);
+
+	/**
+	 * Copies a packed value into a variant.
+	 * @param Type Type of the packed value.
+	 * @param PackedValue Address of the packed value.
+	 * @param OutValue Receives the value.
+	 */
+	static void UnpackValue(EDeprecationVariantType Type, const uint8* PackedValue, Variant& OutValue);
+
+private:
+	template <typename TSource, typename TTarget>
+	void ConvertValues(TArray<TTarget>& OutValues) const
+	{
+		const int32 Num = NumValues();
+		OutValues.SetNumUninitialized(Num);
+
+		// Plain loop over contiguous buffers, left to the compiler to vectorize.
+		const TSource* RESTRICT Source = (const TSource*)PackedValues.GetData();
+		TTarget* RESTRICT Target = OutValues.GetData();
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Target[Index] = (TTarget)Source[Index];
+		}
+	}
+
+
+
+
+	// Operators overload
+public:
+	FDeprecationProperty& operator=(FDeprecationProperty&& Other) = default;
+	FDeprecationProperty& operator=(const FDeprecationProperty& Other) = delete;
+
 
 
 
@@ -267,9 +783,9 @@ public:
 	FName InnerTypeName;
 	FName MapValueTypeName; // For Map properties
 
-	TArray<Variant> Keys;
-	TArray<Variant> Values;
+	TArray<Variant, FDeprecationArenaAllocator> Keys;
+	TArray<Variant, FDeprecationArenaAllocator> Values;
 
-	bool bHasKeyProperties;
-	bool bHasValueProperties;
-};
\ No newline at end of file
+	EDeprecationVariantType PackedValueType;
+	TArray<uint8, FDeprecationArenaAllocator> PackedValues;
+};
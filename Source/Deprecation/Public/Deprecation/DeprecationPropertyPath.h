@@ -0,0 +1,217 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+#include "Deprecation/DeprecationProperty.h"
+
+/**
+ * Reads a typed value from a decoded property, checking the type stored in the property.
+ * Specialized for the types which are not stored as is in variants (strings, arrays).
+ * @param <T> Type of the value to read.
+ */
+template <typename T>
+struct TDeprecationValueReader
+{
+	static inline bool Read(const FDeprecationProperty& Property, int32 Index, T& OutValue)
+	{
+		return Property.TryGetValueAs<T>(Index, OutValue);
+	}
+};
+
+template <>
+struct TDeprecationValueReader<FString>
+{
+	static inline bool Read(const FDeprecationProperty& Property, int32 Index, FString& OutValue)
+	{
+		if (Property.IsPacked() || !Property.Values.IsValidIndex(Index) || Property.Values[Index].GetType() != EDeprecationVariantType::String)
+		{
+			return false;
+		}
+
+		OutValue = Property.Values[Index].GetString();
+		return true;
+	}
+};
+
+template <>
+struct TDeprecationValueReader<FSoftObjectPath>
+{
+	static inline bool Read(const FDeprecationProperty& Property, int32 Index, FSoftObjectPath& OutValue)
+	{
+		if (Property.IsPacked() || !Property.Values.IsValidIndex(Index) || Property.Values[Index].GetType() != EDeprecationVariantType::SoftObjectPath)
+		{
+			return false;
+		}
+
+		OutValue = Property.Values[Index].GetSoftObjectPath();
+		return true;
+	}
+};
+
+/**
+ * Reads all the values of an array or set property, the index is ignored.
+ */
+template <typename T, typename AllocatorType>
+struct TDeprecationValueReader<TArray<T, AllocatorType>>
+{
+	static inline bool Read(const FDeprecationProperty& Property, int32 Index, TArray<T, AllocatorType>& OutValue)
+	{
+		// Packed values of the requested type are copied at once.
+		if (Property.IsPacked() && Property.PackedValueType == TDeprecationVariantTraits<T>::Type)
+		{
+			const TArrayView<const T> PackedValues = Property.GetPackedValues<T>();
+
+			OutValue.Reset(PackedValues.Num());
+			OutValue.Append(PackedValues.GetData(), PackedValues.Num());
+			return true;
+		}
+
+		const int32 NumValues = Property.NumValues();
+
+		OutValue.Reset(NumValues);
+		OutValue.AddDefaulted(NumValues);
+
+		for (int32 ValueIndex = 0; ValueIndex < NumValues; ++ValueIndex)
+		{
+			if (!TDeprecationValueReader<T>::Read(Property, ValueIndex, OutValue[ValueIndex]))
+			{
+				OutValue.Reset();
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+/**
+ * Path to a value nested in a decoded property map: property names separated by dots,
+ * each one with an optional index in its values (e.g. "Transform.Location", "Points[2].X").
+ * Names are hashed once at construction, so paths used for every object should be built once:
+ * static const FDeprecationPropertyPath LocationPath(TEXT("Transform.Location"));
+ */
+class DEPRECATION_API FDeprecationPropertyPath final
+{
+	// Typedefs
+public:
+	/**
+	 * Single property of the path.
+	 */
+	struct FSegment
+	{
+		FName Name;
+
+		/** Index in the values of the property, INDEX_NONE if not specified (first value). */
+		int32 Index;
+	};
+
+
+
+
+	// Constructors
+public:
+	FDeprecationPropertyPath(FStringView Path);
+	FDeprecationPropertyPath(const TCHAR* Path);
+	FDeprecationPropertyPath(const ANSICHAR* Path);
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Resolves the property holding the value at the end of the path.
+	 * @param Root Map holding the first property of the path.
+	 * @param OutIndex Receives the index of the value in the returned property.
+	 * @returns The property if the whole path has been found, nullptr otherwise.
+	 */
+	const FDeprecationProperty* Resolve(const FDeprecationProperty::Map& Root, int32& OutIndex) const;
+
+	/**
+	 * Resolves the property holding the value at the end of the path, from the first property of the path.
+	 * @param RootProperty First property of the path, already found.
+	 * @param OutIndex Receives the index of the value in the returned property.
+	 * @returns The property if the whole path has been found, nullptr otherwise.
+	 */
+	const FDeprecationProperty* Resolve(const FDeprecationProperty& RootProperty, int32& OutIndex) const;
+
+	/**
+	 * Reads the value at the end of the path.
+	 * @param <T> Type of the value, checked against the stored type. TArray<T> reads all the values of an array or set.
+	 * @param Root Map holding the first property of the path.
+	 * @param OutValue Receives the value.
+	 * @returns True if the value has been found with the requested type, false otherwise.
+	 */
+	template <typename T>
+	inline bool TryGet(const FDeprecationProperty::Map& Root, T& OutValue) const
+	{
+		int32 Index;
+		const FDeprecationProperty* Property = Resolve(Root, Index);
+		return Property && TDeprecationValueReader<T>::Read(*Property, Index, OutValue);
+	}
+
+	/**
+	 * Reads the value at the end of the path, from the first property of the path.
+	 * @param <T> Type of the value, checked against the stored type. TArray<T> reads all the values of an array or set.
+	 * @param RootProperty First property of the path, already found.
+	 * @param OutValue Receives the value.
+	 * @returns True if the value has been found with the requested type, false otherwise.
+	 */
+	template <typename T>
+	inline bool TryGet(const FDeprecationProperty& RootProperty, T& OutValue) const
+	{
+		int32 Index;
+		const FDeprecationProperty* Property = Resolve(RootProperty, Index);
+		return Property && TDeprecationValueReader<T>::Read(*Property, Index, OutValue);
+	}
+
+	/**
+	 * Reads the value at the end of the path.
+	 * @param <T> Type of the value, checked against the stored type.
+	 * @param Root Map holding the first property of the path.
+	 * @param DefaultValue Value returned if the path is not found or holds another type.
+	 * @returns The value if found, DefaultValue otherwise.
+	 */
+	template <typename T>
+	inline T Get(const FDeprecationProperty::Map& Root, const T& DefaultValue = T()) const
+	{
+		T Value;
+		return TryGet(Root, Value) ? Value : DefaultValue;
+	}
+
+private:
+	/**
+	 * Parses the segments of a path. Malformed paths (empty names, indices that are not non-negative numbers) ensure
+	 * and have no segment, they never resolve.
+	 */
+	void Parse(FStringView Path);
+
+
+
+
+	// Properties
+public:
+	/**
+	 * Returns the name of the first property of the path, NAME_None if the path is empty.
+	 */
+	inline FName GetRootName() const
+	{
+		return Segments.Num() > 0 ? Segments[0].Name : NAME_None;
+	}
+
+	/**
+	 * Returns the properties of the path, from the root.
+	 */
+	inline TArrayView<const FSegment> GetSegments() const
+	{
+		return Segments;
+	}
+
+
+
+
+	// Fields
+private:
+	TArray<FSegment, TInlineAllocator<4>> Segments;
+};
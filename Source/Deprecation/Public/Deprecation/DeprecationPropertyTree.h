@@ -0,0 +1,131 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Deprecation/DeprecationArena.h"
+#include "Deprecation/DeprecationProperty.h"
+
+/**
+ * Owns a decoded property tree: the root map, every nested map and the arena they are allocated from.
+ * Trees are move-only, moving one never copies nor relocates its properties,
+ * so it can outlive the scope it was decoded by (e.g. to finish an upgrade over several frames).
+ */
+class DEPRECATION_API FDeprecationPropertyTree final
+{
+	// Typedefs
+public:
+	/**
+	 * Object reference decoded in the tree, resolved in batch before the handler runs.
+	 */
+	struct FImport
+	{
+		/** Import held by a variant of the tree, its object is filled once resolved. */
+		FObjectImport* ObjectImport;
+
+		/** Full path of the imported object. */
+		FSoftObjectPath Path;
+	};
+
+
+
+
+	// Constructors
+public:
+	FDeprecationPropertyTree();
+	FDeprecationPropertyTree(FDeprecationPropertyTree&& Other);
+	FDeprecationPropertyTree(const FDeprecationPropertyTree& Other) = delete;
+
+
+
+
+	// Destructor
+public:
+	~FDeprecationPropertyTree();
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Creates an empty nested map, owned by the tree.
+	 * @returns Newly created map, valid for the whole lifetime of the tree.
+	 */
+	FDeprecationProperty::Map* NewMap();
+
+	/**
+	 * Records an object reference decoded in the tree, so it can be resolved with the others.
+	 * @param ObjectImport Import held by a variant of the tree.
+	 * @param Path Full path of the imported object.
+	 */
+	void AddImport(FObjectImport& ObjectImport, FSoftObjectPath&& Path);
+
+	/**
+	 * Fills the object of the imports which are already in memory. Must be called on the game thread.
+	 * @param FirstImport Index of the first import to resolve, the previous ones are left as they are.
+	 * @param OutPackageNames If not null, receives the packages to load for the imports left unresolved, without duplicates.
+	 * @returns Number of imports left unresolved.
+	 */
+	int32 ResolveImports(int32 FirstImport, TArray<FString>* OutPackageNames);
+
+	/**
+	 * Releases all the properties of the tree.
+	 */
+	void Reset();
+
+
+
+
+	// Operators overload
+public:
+	FDeprecationPropertyTree& operator=(FDeprecationPropertyTree&& Other);
+	FDeprecationPropertyTree& operator=(const FDeprecationPropertyTree& Other) = delete;
+
+
+
+
+	// Properties
+public:
+	/**
+	 * Returns the arena holding the data of the tree.
+	 */
+	inline FDeprecationArena& GetArena()
+	{
+		return *Arena;
+	}
+
+	/**
+	 * Returns the object references decoded in the tree, in decoding order.
+	 */
+	inline const TArray<FImport>& GetImports() const
+	{
+		return Imports;
+	}
+
+	/**
+	 * Returns the root map of the tree.
+	 */
+	inline FDeprecationProperty::Map& GetRoot()
+	{
+		return Root;
+	}
+
+	/**
+	 * Returns the root map of the tree.
+	 */
+	inline const FDeprecationProperty::Map& GetRoot() const
+	{
+		return Root;
+	}
+
+
+
+
+	// Fields
+private:
+	// Declared before the root, so it is released last.
+	TUniquePtr<FDeprecationArena> Arena;
+	FDeprecationProperty::Map Root;
+
+	TArray<FImport> Imports;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+#include "Deprecation/DeprecationProperty.h"
+
+/**
+ * Receives the properties of an asset one value at a time, in file order, without any property map being built.
+ * Handlers folding over properties (sums, references...) run in constant memory, whatever the size of the asset.
+ * Driven straight from the archive by FDeprecationScope::Visit, or over a decoded map by Visit.
+ *
+ * Every property is wrapped in BeginProperty/EndProperty. Its value is either a scalar (Visit* callbacks)
+ * or a container wrapping its own values: structures their properties, arrays and sets their elements,
+ * maps the key then the value of each entry. Values passed by reference or view are only valid during the call.
+ */
+class DEPRECATION_API IDeprecationPropertyVisitor
+{
+	// Destructor
+public:
+	virtual ~IDeprecationPropertyVisitor() = default;
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Visits the properties of a decoded map.
+	 * @param Map Map to visit.
+	 */
+	void Visit(const FDeprecationProperty::Map& Map);
+
+	/**
+	 * Visits a decoded property.
+	 * @param Property Property to visit.
+	 */
+	void Visit(const FDeprecationProperty& Property);
+
+	/**
+	 * Called before the value of a property.
+	 * @param Name Name of the property.
+	 * @param Type Type of the property (e.g. IntProperty, StructProperty).
+	 * @returns True to visit the value, false to skip it (EndProperty is not called then).
+	 */
+	virtual bool BeginProperty(FName Name, FName Type) { return true; }
+	virtual void EndProperty(FName Name) { }
+
+	/**
+	 * Called before the properties of a structure saved tagged, natively serialized structures are scalars.
+	 * @param StructName Name of the structure, None for the elements of sets and maps (their tags do not name it).
+	 */
+	virtual void BeginStruct(FName StructName) { }
+	virtual void EndStruct() { }
+
+	virtual void BeginArray(FName InnerType, int32 Num) { }
+	virtual void EndArray() { }
+
+	virtual void BeginSet(FName ElementType, int32 Num) { }
+	virtual void EndSet() { }
+
+	virtual void BeginMap(FName KeyType, FName ValueType, int32 Num) { }
+	virtual void EndMap() { }
+
+	/**
+	 * Called for scalar values: booleans, numbers, names, enumerations and natively serialized structures.
+	 * @param Value Variant holding the value.
+	 */
+	virtual void VisitValue(const FDeprecationProperty::Variant& Value) { }
+
+	virtual void VisitString(FStringView Value) { }
+	virtual void VisitSoftObjectPath(FStringView Path) { }
+
+	/**
+	 * Called for object references, which are never loaded while visiting.
+	 * @param Import Import of the referenced object if it lives in another package, nullptr otherwise.
+	 * @param Export Referenced object if it lives in the package of the asset, nullptr otherwise.
+	 */
+	virtual void VisitObject(const FObjectImport* Import, UObject* Export) { }
+
+	/**
+	 * Called for runs of primitives or math structures packed in arrays and sets, large containers are split in several runs.
+	 * Forwards each value to VisitValue by default.
+	 * @param Type Type of the values.
+	 * @param Values Address of the first value.
+	 * @param Num Number of values in the run.
+	 */
+	virtual void VisitPackedValues(EDeprecationVariantType Type, const uint8* Values, int32 Num);
+
+private:
+	void VisitDecodedValues(const FDeprecationProperty& Property);
+	void VisitDecodedValue(const FDeprecationProperty::Variant& Value, FName StructName);
+};
@@ -6,14 +6,51 @@
 
 #include "DeprecationProperty.h"
 
+#include "Deprecation/DeprecationFieldRules.h"
+#include "Deprecation/DeprecationSteps.h"
+#include "Deprecation/DeprecationPropertyPath.h"
 #include "Deprecation/DeprecationPropertyTag.h"
+#include "Deprecation/DeprecationPropertyTree.h"
+#include "Deprecation/DeprecationPropertyVisitor.h"
+#include "Deprecation/DeprecationStructDecoders.h"
+#include "Deprecation/DeprecationTagIndex.h"
+
+#include "UObject/SoftObjectPath.h"
+
+/**
+ * Deprecation scopes are compiled out of shipping builds, unless the project opts in to upgrade content
+ * written by older clients at runtime (save games, downloaded content): DEPRECATION_ENABLE_IN_SHIPPING=1
+ * in the global definitions of its target. Decoding is then bounded by Deprecation.MaxDecodedBytesPerObject,
+ * and deferred upgrades by Deprecation.PendingUpgradesBudgetMs.
+ */
+#ifndef DEPRECATION_ENABLE_IN_SHIPPING
+#define DEPRECATION_ENABLE_IN_SHIPPING 0
+#endif
+
+#define DEPRECATION_ENABLED (!UE_BUILD_SHIPPING || DEPRECATION_ENABLE_IN_SHIPPING)
+
+struct FDeprecationClassInfo;
+struct FDeprecationDecodeTask;
+struct FDeprecationLinkerTables;
+struct FDeprecationPendingUpgrade;
 
 /**
  * Creates a deprecation property map from an asset so old structure can be handled by new code.
  * Property map is generated and deprecation is handled at destruction time.
+ * On the async loading thread, the map is generated at destruction time and the handler is deferred to the game thread (see DEPRECATION_POST_LOAD).
+ * With Deprecation.QueueUpgrades, every upgrade is deferred and its map generated on a worker thread, to spread large loads over several frames.
+ * With Deprecation.PersistentCache, maps generated for objects of packages are cached on disk until the package is saved again.
+ * Unversioned properties (cooked packages) have no tags: they are listed from the schema of the class to find the version,
+ * but their upgrades are refused, the schema they were saved with being unknown.
  */
 class DEPRECATION_API FDeprecationScope final
 {
+	// Friends
+private:
+	friend class FDeprecationPendingUpgrades;
+
+
+
 	// Typedefs
 public:
 	/**
@@ -25,6 +62,24 @@ public:
 	typedef void (UObject::*DeprecationHandler)
 		(const FDeprecationProperty::Map& PropertyMap, uint64 AssetVersion, uint64 CodeVersion);
 
+	/**
+	 * Signature to handle an asset from old structure, decoding only the properties it asks for.
+	 * Properties are retrieved through FindProperty on the given scope.
+	 * @param Scope Scope of the asset being upgraded.
+	 * @param AssetVersion Version of the asset at load time.
+	 * @param CodeVersion Version of the code.
+	 */
+	typedef void (UObject::*LazyDeprecationHandler)
+		(FDeprecationScope& Scope, uint64 AssetVersion, uint64 CodeVersion);
+
+	/**
+	 * Event broadcast on the game thread once the deprecation handler of an object has run.
+	 * @param Object Upgraded object.
+	 * @param AssetVersion Version of the asset at load time.
+	 * @param CodeVersion Version of the code.
+	 */
+	DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnObjectUpgraded, UObject* /*Object*/, uint64 /*AssetVersion*/, uint64 /*CodeVersion*/);
+
 
 
 	// Constructors
@@ -34,11 +89,55 @@ public:
 	 * @param Object Instance of the asset before serialization.
 	 * @param Record Pointer to the record file before serialization.
 	 * @param Handler Pointer to member function that handles data deprecation.
-	 * @param VersionPropertyName Name of the property holding the deprecation version. Mandatory in the class of Object.
+	 * @param VersionPropertyName Name of the property holding the deprecation version (DeprecationVersion if none). Mandatory in the class of Object.
 	 */
-	FDeprecationScope(UObject* Object, FStructuredArchive::FRecord& Record, DeprecationHandler Handler, FString VersionPropertyName = "DeprecationVersion");
+	FDeprecationScope(UObject* Object, FStructuredArchive::FRecord& Record, DeprecationHandler Handler, FName VersionPropertyName = NAME_None);
+
+	/**
+	 * Creates a new scope for the given asset, with properties decoded on demand.
+	 * @param Object Instance of the asset before serialization.
+	 * @param Record Pointer to the record file before serialization.
+	 * @param LazyHandler Pointer to member function that handles data deprecation.
+	 * @param VersionPropertyName Name of the property holding the deprecation version (DeprecationVersion if none). Mandatory in the class of Object.
+	 */
+	FDeprecationScope(UObject* Object, FStructuredArchive::FRecord& Record, LazyDeprecationHandler LazyHandler, FName VersionPropertyName = NAME_None);
+
+	/**
+	 * Creates a new scope for the given asset, upgraded by the field rules (see DEPRECATION_FIELD_RULES)
+	 * and the steps (see DEPRECATION_STEPS) of its class only. Only the properties declared by the steps are decoded.
+	 * @param Object Instance of the asset before serialization.
+	 * @param Record Pointer to the record file before serialization.
+	 * @param VersionPropertyName Name of the property holding the deprecation version (DeprecationVersion if none). Mandatory in the class of Object.
+	 */
+	FDeprecationScope(UObject* Object, FStructuredArchive::FRecord& Record, FName VersionPropertyName = NAME_None);
+
+	/**
+	 * Same as above, for version property names given as strings, as they were before names were used.
+	 */
+	FDeprecationScope(UObject* Object, FStructuredArchive::FRecord& Record, DeprecationHandler Handler, const FString& VersionPropertyName);
+	FDeprecationScope(UObject* Object, FStructuredArchive::FRecord& Record, DeprecationHandler Handler, const TCHAR* VersionPropertyName);
+	FDeprecationScope(UObject* Object, FStructuredArchive::FRecord& Record, LazyDeprecationHandler LazyHandler, const FString& VersionPropertyName);
+	FDeprecationScope(UObject* Object, FStructuredArchive::FRecord& Record, LazyDeprecationHandler LazyHandler, const TCHAR* VersionPropertyName);
 	FDeprecationScope(const FDeprecationScope& Other) = delete;
 
+private:
+	FDeprecationScope(UObject* Object, FStructuredArchive::FRecord& Record,
+		DeprecationHandler Handler, LazyDeprecationHandler LazyHandler, FName VersionPropertyName);
+
+	/**
+	 * Creates a scope detached from any archive, over the decoded tree of a deferred upgrade.
+	 * @param Object Object being upgraded.
+	 * @param Upgrade Pending upgrade, its tree and tag index are moved into the scope.
+	 */
+	FDeprecationScope(UObject* Object, FDeprecationPendingUpgrade& Upgrade);
+
+	/**
+	 * Creates a scope decoding the snapshot of a deferred upgrade, away from its object.
+	 * @param Task Decoding task, its tree and tag index are moved into the scope.
+	 * @param SnapshotRecord Record reading the snapshot of the task.
+	 */
+	FDeprecationScope(FDeprecationDecodeTask& Task, FStructuredArchive::FRecord& SnapshotRecord);
+
 
 
 	
@@ -51,11 +150,131 @@ public:
 
 	// Methods
 public:
+	/**
+	 * Looks for a property of the asset, decoding its value the first time it is requested.
+	 * Only valid while the deprecation handler is running.
+	 * Returned pointers stay valid for the whole lifetime of the scope.
+	 * @param PropertyName Name of the property to retrieve.
+	 * @returns The property if found in the asset file, nullptr otherwise.
+	 */
+	const FDeprecationProperty* FindProperty(FName PropertyName);
+
+	/**
+	 * Reads a value of the asset at the given path, decoding its root property on demand.
+	 * Only valid while the deprecation handler is running.
+	 * @param <T> Type of the value, checked against the stored type. TArray<T> reads all the values of an array or set.
+	 * @param Path Path of the value (e.g. "Transform.Location"), build it once for handlers running on many objects.
+	 * @param OutValue Receives the value.
+	 * @returns True if the value has been found with the requested type, false otherwise.
+	 */
+	template <typename T>
+	inline bool TryGet(const FDeprecationPropertyPath& Path, T& OutValue)
+	{
+		const FDeprecationProperty* RootProperty = FindProperty(Path.GetRootName());
+		return RootProperty && Path.TryGet(*RootProperty, OutValue);
+	}
+
+	/**
+	 * Reads a value of the asset at the given path, decoding its root property on demand.
+	 * Only valid while the deprecation handler is running.
+	 * @param <T> Type of the value, checked against the stored type. TArray<T> reads all the values of an array or set.
+	 * @param Path Path of the value (e.g. "Transform.Location"), build it once for handlers running on many objects.
+	 * @param DefaultValue Value returned if the path is not found or holds another type.
+	 * @returns The value if found, DefaultValue otherwise.
+	 */
+	template <typename T>
+	inline T Get(const FDeprecationPropertyPath& Path, const T& DefaultValue = T())
+	{
+		T Value;
+		return TryGet(Path, Value) ? Value : DefaultValue;
+	}
+
+	/**
+	 * Streams the properties of the asset to a visitor straight from the archive, without building any property map.
+	 * Only valid while the deprecation handler is running.
+	 * Scopes of deferred upgrades have no archive left, their decoded tree is visited instead.
+	 * @param Visitor Visitor receiving the properties.
+	 */
+	void Visit(IDeprecationPropertyVisitor& Visitor);
+
+	/**
+	 * Streams a single property of the asset to a visitor, see Visit.
+	 * @param PropertyName Name of the property to visit.
+	 * @param Visitor Visitor receiving the property.
+	 * @returns True if the property is present in the asset file, false otherwise.
+	 */
+	bool Visit(FName PropertyName, IDeprecationPropertyVisitor& Visitor);
+
+	/**
+	 * Decodes all the remaining properties and transfers the decoded tree to the caller,
+	 * so it can be kept after the scope is destroyed. Only valid while the deprecation handler is running.
+	 * Properties found afterwards are decoded in a new tree.
+	 * @returns The decoded tree.
+	 */
+	FDeprecationPropertyTree ReleaseTree();
+
+	/**
+	 * Checks if a property is present in the asset file, without decoding its value.
+	 * @param PropertyName Name of the property to look for.
+	 * @returns True if the property is present, false otherwise.
+	 */
+	inline bool HasProperty(FName PropertyName) const
+	{
+		return TagIndex.Find(PropertyName) != nullptr;
+	}
+
+	/**
+	 * Retrieves the custom version recording the deprecation version of a class in package summaries.
+	 * Lets tools tell whether a package is outdated without loading it.
+	 * @param Class Class declaring the version property.
+	 * @param VersionPropertyName Name of the property holding the deprecation version (DeprecationVersion if none).
+	 * @param OutKey Key of the custom version.
+	 * @param OutVersion Current code version of the class.
+	 * @returns True if the class records its version in package summaries, false otherwise.
+	 */
+	static bool GetClassCustomVersion(UClass* Class, FName VersionPropertyName, FGuid& OutKey, int32& OutVersion);
+
+	/**
+	 * Returns the event broadcast when an object has been upgraded.
+	 */
+	static FOnObjectUpgraded& OnObjectUpgraded();
+
+	/**
+	 * Runs the deferred upgrade of an object, if its handler could not run while it was loaded (async loading thread).
+	 * Meant to be called from PostLoad (see DEPRECATION_POST_LOAD), upgrades left pending are run by a ticker on the game thread.
+	 * @param Object Object to upgrade.
+	 * @returns True if a pending upgrade has been run, false otherwise.
+	 */
+	static bool FinishPendingUpgrade(UObject* Object);
+
+	/**
+	 * Runs the pending upgrades of all the objects that are fully loaded, for tools where the core ticker does not tick (e.g. commandlets).
+	 * Blocks until their properties are decoded and the objects they reference are loaded.
+	 * @returns Number of upgrades run.
+	 */
+	static int32 FlushPendingUpgrades();
+
+	/**
+	 * Checks if an object has an upgrade waiting to run.
+	 * @param Object Object to check.
+	 * @returns True if the deprecation handler of the object has not run yet, false otherwise.
+	 */
+	static bool IsUpgradePending(const UObject* Object);
+
+	/**
+	 * Loads an object asynchronously, so handlers never block on their dependencies.
+	 * @param Path Path of the object to load.
+	 * @param Callback Function called on the game thread with the loaded object (nullptr if it could not be loaded).
+	 */
+	static void LoadObjectAsync(const FSoftObjectPath& Path, TFunction<void(UObject*)> Callback);
+
 	/**
 	 * Helper function to load an asset from the ObjectImport instance.
+	 * Imports of the decoded tree are resolved in batch before the handler runs, so this only loads
+	 * (synchronously) the ones which could not be resolved. It must not be used on the async loading thread (see LoadObjectAsync).
 	 * @param <TObject> Type of the object to load.
 	 * @param ObjectImport Instance of the ObjectImport (retrieved in deprecation data).
-	 * @returns Instance of the loaded object.
+	 * @returns Instance of the loaded object, nullptr if it could not be loaded.
 	 */
 	template <class TObject>
 	inline static TObject* LoadObjectFromImport(const FObjectImport& ObjectImport)
@@ -65,11 +284,57 @@ public:
 			return Cast<TObject>(ObjectImport.XObject);
 		}
 
+		if (!ObjectImport.SourceLinker || ObjectImport.SourceIndex == INDEX_NONE)
+		{
+			return nullptr;
+		}
+
+		ensureMsgf(!IsInAsyncLoadingThread(), TEXT("Synchronous load from the async loading thread, use LoadObjectAsync instead."));
+
+		// Path of the imported object itself, not only of the package holding it.
 		return LoadObject<TObject>
-			(nullptr, *ObjectImport.SourceLinker->LinkerRoot->FileName.ToString());
+			(nullptr, *ObjectImport.SourceLinker->GetExportPathName(ObjectImport.SourceIndex));
 	}
 
 private:
+	/**
+	 * Checks if the handler has to be deferred, because synchronous loads are not allowed where the object is serialized.
+	 */
+	static bool ShouldDeferHandler();
+
+	/**
+	 * Runs the handler of an upgrade deferred out of serialization.
+	 * @param Upgrade Pending upgrade, with its fully decoded tree.
+	 */
+	static void RunDeferredHandler(FDeprecationPendingUpgrade& Upgrade);
+
+	/**
+	 * Runs the pending upgrades of an object about to be saved, loading the packages they reference if needed.
+	 * @param Object Object to upgrade.
+	 * @param OutAssetVersion Version of the asset, if upgrades are still pending.
+	 * @returns True if upgrades are still pending (saved from another thread, or still being loaded), false otherwise.
+	 */
+	static bool FinishPendingUpgradeForSave(UObject* Object, uint64& OutAssetVersion);
+
+	/**
+	 * Writes the tag and value of the version property ahead of the tagged properties of the object, if delta serialization would skip it.
+	 * @param UnderlyingArchive Saving archive, positioned on the first tag of the object.
+	 */
+	void WriteVersionProperty(FArchive& UnderlyingArchive);
+
+	/**
+	 * Snapshots the property data of the object to decode it on a worker thread, if the upgrades are queued and the archive allows it.
+	 * @param Upgrade Upgrade being deferred, receives the decoding task.
+	 * @returns True if the decoding has been started, false if the properties must be decoded right away.
+	 */
+	bool StartDecodeTask(FDeprecationPendingUpgrade& Upgrade);
+
+	/**
+	 * Decodes the tree of a deferred upgrade from its snapshot, on a worker thread.
+	 * @param Task Decoding task.
+	 */
+	static void DecodeSnapshot(FDeprecationDecodeTask& Task);
+
 	/**
 	 * Checks if asset is deprecated comparing the versions of the asset and the code.
 	 * @param AssetVersion Version of the asset (retrieved through the file).
@@ -78,22 +343,129 @@ private:
 	bool CheckDeprecation(uint64& AssetVersion);
 
 	/**
-	 * Generates the property map from the asset file.
-	 * @param TargetMap Map to fill with found properties.
-	 * @param Stream File stream used to retrieve data.
+	 * Checks if more property data can be decoded for the object, see Deprecation.MaxDecodedBytesPerObject.
+	 * @param NumBytes Serialized size of the properties to decode.
+	 * @returns True if the data fits in the budget, false otherwise.
+	 */
+	bool IsWithinDecodeBudget(int64 NumBytes) const;
+
+	/**
+	 * Computes the serialized size of the properties decoded by the upgrade, to check it against the budget before running anything.
+	 * @param AssetVersion Version of the asset.
+	 * @returns Size of the whole root for handlers, the one of the properties declared by the steps to run otherwise.
+	 */
+	int64 GetUpgradeSerializedSize(uint64 AssetVersion) const;
+
+	/**
+	 * Leaves the object at the version of the asset, because its upgrade needs more memory than allowed or its data cannot be decoded.
+	 * @param AssetVersion Version of the asset.
+	 * @param Reason Why the upgrade is refused, for the log.
+	 */
+	void RefuseUpgrade(uint64 AssetVersion, const TCHAR* Reason);
+
+	/**
+	 * Sets the key of the tree in the persistent cache, if enabled and the object is loaded from a package.
+	 * @param AssetVersion Version of the asset.
+	 */
+	void PrepareTreeCache(uint64 AssetVersion);
+
+	/**
+	 * Applies the field rules of the class, streaming each property they map straight into the object.
+	 * @param AssetVersion Version of the asset.
+	 */
+	void ApplyFieldRules(uint64 AssetVersion);
+
+	/**
+	 * Reads the value of a property of the asset file into a property of the object, converting numeric types.
+	 * @param Entry Entry of the property in the tag index.
+	 * @param Property Property of the object to read to.
+	 * @param Value Address of the value of the property in the object.
+	 * @returns True if the value has been read, false if the types can not be converted.
+	 */
+	bool ApplyFieldRule(const FDeprecationTagIndex::FEntry& Entry, FProperty* Property, void* Value);
+
+	/**
+	 * Runs the steps of the chain between the version of the asset and the version of the code, in order.
+	 * @param Steps Chain of steps of the class.
+	 * @param AssetVersion Version of the asset.
+	 */
+	void RunSteps(const FDeprecationSteps& Steps, uint64 AssetVersion);
+
+	/**
+	 * Decodes the properties declared by the steps to run, and only them.
+	 * @param Steps Chain of steps of the class.
+	 * @param AssetVersion Version of the asset.
+	 */
+	void GenerateStepProperties(const FDeprecationSteps& Steps, uint64 AssetVersion);
+
+	/**
+	 * Builds the tag index from the asset file, skipping over property values.
+	 * @param Stream File stream used to retrieve tags, positioned on the next tag to read.
+	 * @param StopPropertyName Name of the property to stop at (its tag is added to the index), NAME_None to read all tags.
+	 * @returns True if the property to stop at was found, false otherwise.
+	 */
+	bool GenerateTagIndex(FStructuredArchive::FStream& Stream, FName StopPropertyName = NAME_None);
+
+	/**
+	 * Builds the tag index from the header of unversioned properties, matched against the schema of the class.
+	 * @param UnderlyingArchive Archive positioned on the header.
+	 * @param StopPropertyName Name of the property to look for.
+	 * @returns True if the property looked for has been saved, false otherwise.
 	 */
-	void GenerateRoot(FDeprecationProperty::Map& TargetMap, FStructuredArchive::FStream& Stream);
+	bool GenerateUnversionedTagIndex(FArchive& UnderlyingArchive, FName StopPropertyName);
 
 	/**
-	 * Generates value data from the file stream.
-	 * @param Tag Property tag used to know the type of data streamed.
-	 * @param Linker Optional linker instance for Object properties.
-	 * @param TargetProperty Property to fill with data.
-	 * @param bIsKey Indicates whether data should be stored in keys or values.
+	 * Reads the remaining tags, if the constructor probe stopped before the end.
+	 */
+	void CompleteTagIndex();
+
+	/**
+	 * Reserves the root map for every property of the tag index.
+	 */
+	void ReserveRoot();
+
+	/**
+	 * Generates the whole root map from the tag index, skipping properties already decoded.
+	 */
+	void GenerateRoot();
+
+	/**
+	 * Resolves the imports decoded since the last call, loading all their packages at once.
+	 */
+	void ResolveImports();
+
+	/**
+	 * Generates a property of the root map from its entry in the tag index.
+	 * @param Entry Entry of the property in the tag index.
+	 * @returns Newly generated property.
+	 */
+	FDeprecationProperty& GenerateProperty(const FDeprecationTagIndex::FEntry& Entry);
+
+	/**
+	 * Streams a property of the root from its entry in the tag index.
+	 * @param Entry Entry of the property in the tag index.
+	 * @param Visitor Visitor receiving the property.
+	 */
+	void VisitProperty(const FDeprecationTagIndex::FEntry& Entry, IDeprecationPropertyVisitor& Visitor);
+
+	/**
+	 * Decodes the properties of a structure saved tagged, up to its terminating tag.
+	 * @param Stream File stream positioned on the first tag of the structure.
+	 * @param Sink Receiver of the decoded values, either the property tree or a visitor.
+	 */
+	template <typename SinkType>
+	void DecodeStruct(FStructuredArchive::FStream& Stream, SinkType& Sink);
+
+	/**
+	 * Decodes value data from the file stream, the single decoder of tagged data behind the property map and visitors.
+	 * @param Tag Property tag used to know the type of data decoded.
+	 * @param StructDecoder Decoder of the structure of the tag, resolved once per tag (see FindStructDecoder), without function if none.
 	 * @param ValueStream File stream used to retrieve data.
+	 * @param Sink Receiver of the decoded values, either the property tree or a visitor.
 	 */
-	void GenerateValue(FDeprecationPropertyTag& Tag, FLinkerLoad* Linker,
-		FDeprecationProperty& TargetProperty, bool bIsKey, FStructuredArchive::FStream& ValueStream);
+	template <typename SinkType>
+	void DecodeValue(FDeprecationPropertyTag& Tag, const FDeprecationStructDecoders::FDecoder& StructDecoder,
+		FStructuredArchive::FStream& ValueStream, SinkType& Sink);
 
 
 
@@ -109,10 +481,11 @@ public:
 public:
 	/**
 	 * Returns the root map from the current object.
+	 * With a lazy handler, only holds the properties decoded so far.
 	 */
 	inline const FDeprecationProperty::Map& GetRoot() const
 	{
-		return Root;
+		return Tree.GetRoot();
 	}
 
 
@@ -123,23 +496,53 @@ private:
 	UObject* Object;
 	FStructuredArchive::FRecord* Record;
 	DeprecationHandler Handler;
+	LazyDeprecationHandler LazyHandler;
 
 	UClass* ObjectClass;
+	TSharedPtr<const FDeprecationClassInfo, ESPMode::ThreadSafe> ClassInfo;
 	FUInt64Property* VersionProperty;
-	FString VersionPropertyName;
+	FName VersionPropertyName;
 
 	uint64 PreSerializePosition;
 	uint64 PostSerializePosition;
 
-	FDeprecationProperty::Map Root;
+	FDeprecationTagIndex TagIndex;
+	FDeprecationPropertyTree Tree;
+	int32 NumResolvedImports;
+
+	/** Serialized size of the properties decoded so far, bounded by the decode budget. */
+	int64 NumDecodedBytes;
+
+	/** Tables of the linker the snapshot being decoded comes from, null when decoding from the archive. */
+	const FDeprecationLinkerTables* LinkerTables;
+
+	/** Key of the tree in the persistent cache (see FDeprecationTreeCache), empty if not cached or already cached. */
+	FString CacheKey;
+
+	/** Tables of the linker loading the object, mapping the exports of the cached tree. */
+	TSharedPtr<const FDeprecationLinkerTables, ESPMode::ThreadSafe> CacheTables;
+
+	/** Step running, properties read by the handler must be declared by it. */
+	const FDeprecationSteps::FStep* CurrentStep;
 
 	bool bIsLoading;
+
+	/** Whether or not properties are saved without tags, through the schema of the class. */
+	bool bIsUnversioned;
+
+	bool bIsHandlingDeprecation;
 	bool bAssetHasDeprecationProperty;
 
+	/** Whether or not a property has been refused to the handler for exceeding the decode budget, the upgrade is then refused too. */
+	bool bHasExceededBudget;
+
+	/** Whether or not the object is saved at the version of its asset, because its upgrade is still pending. */
+	bool bIsSavingPendingUpgrade;
+
 	uint64 CodeVersion;
 };
 
-#if !UE_BUILD_SHIPPING
+#if DEPRECATION_ENABLED
 
 /**
  * Creates a temporary Deprecation Scope for the current asset.
@@ -152,11 +555,46 @@ private:
 #define DEPRECATION_SCOPE_LOCAL(Handler) DEPRECATION_SCOPE(this, Record, Handler)
 #define DEPRECATION_SCOPE_LOCAL_CUSTOM_VERSION_PROPERTY(Handler, VersionPropertyName) DEPRECATION_SCOPE_CUSTOM_VERSION_PROPERTY(Handler, VersionPropertyName)
 
+/**
+ * Creates a temporary Deprecation Scope for the current asset, decoding properties on demand.
+ * @param Object Object to check deprecation for.
+ * @param Record Instance of the asset file record, before serialization.
+ * @param Handler Pointer to member function taking the scope, that will handle deprecation.
+ */
+#define DEPRECATION_SCOPE_LAZY(Object, Record, Handler) FDeprecationScope __DeprScope__(Object, Record, (FDeprecationScope::LazyDeprecationHandler)(Handler));
+#define DEPRECATION_SCOPE_LAZY_CUSTOM_VERSION_PROPERTY(Object, Record, Handler, VersionPropertyName) FDeprecationScope __DeprScope__(Object, Record, (FDeprecationScope::LazyDeprecationHandler)(Handler), VersionPropertyName);
+#define DEPRECATION_SCOPE_LAZY_LOCAL(Handler) DEPRECATION_SCOPE_LAZY(this, Record, Handler)
+#define DEPRECATION_SCOPE_LAZY_LOCAL_CUSTOM_VERSION_PROPERTY(Handler, VersionPropertyName) DEPRECATION_SCOPE_LAZY_CUSTOM_VERSION_PROPERTY(this, Record, Handler, VersionPropertyName)
+
+/**
+ * Creates a temporary Deprecation Scope for the current asset, upgraded by the field rules and the steps of its class only.
+ * @param Object Object to check deprecation for.
+ * @param Record Instance of the asset file record, before serialization.
+ */
+#define DEPRECATION_SCOPE_RULES(Object, Record) FDeprecationScope __DeprScope__(Object, Record);
+#define DEPRECATION_SCOPE_RULES_CUSTOM_VERSION_PROPERTY(Object, Record, VersionPropertyName) FDeprecationScope __DeprScope__(Object, Record, VersionPropertyName);
+#define DEPRECATION_SCOPE_RULES_LOCAL() DEPRECATION_SCOPE_RULES(this, Record)
+#define DEPRECATION_SCOPE_RULES_LOCAL_CUSTOM_VERSION_PROPERTY(VersionPropertyName) DEPRECATION_SCOPE_RULES_CUSTOM_VERSION_PROPERTY(this, Record, VersionPropertyName)
+
+/**
+ * Runs the upgrade of the current object if it was deferred while loading, to be placed in PostLoad.
+ */
+#define DEPRECATION_POST_LOAD() FDeprecationScope::FinishPendingUpgrade(this);
+
 #else
 
 #define DEPRECATION_SCOPE(Object, Record, Handler)
 #define DEPRECATION_SCOPE_CUSTOM_VERSION_PROPERTY(Object, Record, Handler, VersionPropertyName)
 #define DEPRECATION_SCOPE_LOCAL(Handler)
 #define DEPRECATION_SCOPE_LOCAL_CUSTOM_VERSION_PROPERTY(Handler, VersionPropertyName)
-
-#endif // !UE_BUILD_SHIPPING
\ No newline at end of file
+#define DEPRECATION_SCOPE_LAZY(Object, Record, Handler)
+#define DEPRECATION_SCOPE_LAZY_CUSTOM_VERSION_PROPERTY(Object, Record, Handler, VersionPropertyName)
+#define DEPRECATION_SCOPE_LAZY_LOCAL(Handler)
+#define DEPRECATION_SCOPE_LAZY_LOCAL_CUSTOM_VERSION_PROPERTY(Handler, VersionPropertyName)
+#define DEPRECATION_SCOPE_RULES(Object, Record)
+#define DEPRECATION_SCOPE_RULES_CUSTOM_VERSION_PROPERTY(Object, Record, VersionPropertyName)
+#define DEPRECATION_SCOPE_RULES_LOCAL()
+#define DEPRECATION_SCOPE_RULES_LOCAL_CUSTOM_VERSION_PROPERTY(VersionPropertyName)
+#define DEPRECATION_POST_LOAD()
+
+#endif // DEPRECATION_ENABLED
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FDeprecationScope;
+
+/**
+ * Chain of handlers of a class, one per version step, instead of a single handler testing versions.
+ * Only the steps between the version of an asset and the version of the code run, in order,
+ * and only the properties they declare are decoded for them.
+ */
+class DEPRECATION_API FDeprecationSteps final
+{
+	// Typedefs
+public:
+	/**
+	 * Signature of the handler of a step, reading the properties it declared through the scope.
+	 * @param Scope Scope of the asset being upgraded.
+	 */
+	typedef void (UObject::*StepHandler)(FDeprecationScope& Scope);
+
+	/**
+	 * Single step of the chain, upgrading assets to its version.
+	 */
+	struct FStep
+	{
+		/** Version the step upgrades to, it runs for assets saved with an older version. */
+		uint64 Version;
+
+		StepHandler Handler;
+
+		/** Names of the properties of the asset read by the handler, decoded before it runs. */
+		TArray<FName> Properties;
+	};
+
+	typedef UClass* (*ClassGetter)();
+	typedef void (*RegisterFunction)(FDeprecationSteps& Steps);
+
+	/**
+	 * Registers the steps of a class at static initialization time, see DEPRECATION_STEPS.
+	 */
+	struct DEPRECATION_API FRegistrar
+	{
+		/**
+		 * @param GetClass Function returning the class of the steps (StaticClass), only called once UObjects are initialized.
+		 * @param VersionPropertyName Name of the property holding the deprecation version the steps refer to.
+		 * @param Register Function adding the steps.
+		 */
+		FRegistrar(ClassGetter GetClass, const TCHAR* VersionPropertyName, RegisterFunction Register);
+	};
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Adds a step to the chain.
+	 * @param <TClass> Class declaring the handler.
+	 * @param Version Version the step upgrades to.
+	 * @param Handler Pointer to member function upgrading the asset.
+	 * @param Properties Names of the properties of the asset read by the handler.
+	 */
+	template <typename TClass>
+	inline FDeprecationSteps& Add(uint64 Version, void (TClass::*Handler)(FDeprecationScope&), TArray<FName> Properties)
+	{
+		static_assert(TIsDerivedFrom<TClass, UObject>::IsDerived, "Step handlers must be members of a UObject class.");
+		return AddStep(Version, static_cast<StepHandler>(Handler), MoveTemp(Properties));
+	}
+
+	/**
+	 * Sorts the steps by version.
+	 */
+	void Sort();
+
+	/**
+	 * Checks the chain against the version of the code.
+	 * @param Class Class of the steps, for error messages.
+	 * @param CodeVersion Version of the code.
+	 * @returns True if every step has its own version, not greater than the version of the code, false otherwise.
+	 */
+	bool Validate(const UClass* Class, uint64 CodeVersion) const;
+
+private:
+	FDeprecationSteps& AddStep(uint64 Version, StepHandler Handler, TArray<FName>&& Properties);
+
+
+
+
+	// Properties
+public:
+	/**
+	 * Returns the steps, sorted by version once registered.
+	 */
+	inline const TArray<FStep>& GetSteps() const
+	{
+		return Steps;
+	}
+
+	/**
+	 * Returns whether or not there is at least one step.
+	 */
+	inline bool IsEmpty() const
+	{
+		return Steps.Num() == 0;
+	}
+
+
+
+
+	// Fields
+private:
+	TArray<FStep> Steps;
+};
+
+/**
+ * Declares the function registering the steps of a class, to be placed in the class body.
+ * Leaves the class body in public access.
+ */
+#define DEPRECATION_DECLARE_STEPS() \
+	public: \
+	static void RegisterDeprecationSteps(FDeprecationSteps& Steps);
+
+/**
+ * Defines the steps of a class, in a source file. The body receives the chain to fill as Steps:
+ *
+ * DEPRECATION_STEPS(UMyObject)
+ * {
+ *     Steps.Add(2, &UMyObject::UpgradeToHealth, { TEXT("Hp") });
+ *     Steps.Add(3, &UMyObject::UpgradeToTransform, { TEXT("Location"), TEXT("Rotation") });
+ * }
+ *
+ * Objects of the class run them through a DEPRECATION_SCOPE_RULES scope (or any scope, before their handler).
+ * @param ClassName Class of the steps, declaring them with DEPRECATION_DECLARE_STEPS. The steps also run for its child classes.
+ */
+#define DEPRECATION_STEPS(ClassName) DEPRECATION_STEPS_CUSTOM_VERSION_PROPERTY(ClassName, DeprecationVersion)
+
+/**
+ * Defines the steps of a class, for the given version property.
+ * @param ClassName Class of the steps, declaring them with DEPRECATION_DECLARE_STEPS. The steps also run for its child classes.
+ * @param VersionPropertyName Name of the property holding the deprecation version, as an identifier.
+ */
+#define DEPRECATION_STEPS_CUSTOM_VERSION_PROPERTY(ClassName, VersionPropertyName) \
+	static const FDeprecationSteps::FRegistrar DeprecationStepsRegistrar_##ClassName( \
+		&ClassName::StaticClass, TEXT(#VersionPropertyName), &ClassName::RegisterDeprecationSteps); \
+	void ClassName::RegisterDeprecationSteps(FDeprecationSteps& Steps)
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+
+#include "Deprecation/DeprecationProperty.h"
+
+/**
+ * Decoders of the structures serialized natively (immutable structures or structures with their own serializer),
+ * reading a value straight from the archive into a variant instead of decoding a nested property map.
+ * Core math structures are registered by default, projects add their own with DEPRECATION_BINARY_STRUCT.
+ */
+class DEPRECATION_API FDeprecationStructDecoders final
+{
+	// Typedefs
+public:
+	/**
+	 * Reads a serialized value and stores it in a variant.
+	 * @param Archive Archive positioned on the value.
+	 * @param Variant Variant receiving the value.
+	 */
+	typedef void (*DecodeFunction)(FArchive& Archive, FDeprecationProperty::Variant& Variant);
+
+	struct FDecoder
+	{
+		/** nullptr if the structure has no decoder. */
+		DecodeFunction Decode = nullptr;
+
+		/** Size in bytes of a serialized value, values of another size are decoded as tagged structures. */
+		int32 SerializedSize = 0;
+	};
+
+	/**
+	 * Registers the decoder of a structure at static initialization time, see DEPRECATION_BINARY_STRUCT.
+	 * @param <T> C++ type of the structure.
+	 */
+	template <typename T>
+	struct TRegistrar
+	{
+		/**
+		 * @param StructName Name of the structure, without the F prefix of its C++ type.
+		 * @param SerializedSize Size in bytes of a serialized value.
+		 */
+		TRegistrar(const TCHAR* StructName, int32 SerializedSize)
+		{
+			FDeprecationStructDecoders::Get().Add<T>(StructName, SerializedSize);
+		}
+	};
+
+
+
+
+	// Constructors
+private:
+	FDeprecationStructDecoders();
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Returns the instance of the decoders.
+	 */
+	static FDeprecationStructDecoders& Get();
+
+	/**
+	 * Adds the decoder of a structure, reading it with its FArchive serialization operator.
+	 * Types a variant can hold are stored as such, other types are stored with SetStruct.
+	 * @param <T> C++ type of the structure, default constructible and copyable.
+	 * @param StructName Name of the structure.
+	 * @param SerializedSize Size in bytes of a serialized value.
+	 */
+	template <typename T>
+	inline void Add(FName StructName, int32 SerializedSize)
+	{
+		Add(StructName, &DecodeValue<T>, SerializedSize);
+	}
+
+	/**
+	 * Adds the decoder of a structure.
+	 * @param StructName Name of the structure.
+	 * @param Decode Function reading a value.
+	 * @param SerializedSize Size in bytes of a serialized value.
+	 */
+	void Add(FName StructName, DecodeFunction Decode, int32 SerializedSize);
+
+	/**
+	 * Finds the decoder of a structure, can be called from any thread.
+	 * @param StructName Name of the structure.
+	 * @param OutDecoder Receives the decoder.
+	 * @returns True if the structure has a decoder, false otherwise.
+	 */
+	bool Find(FName StructName, FDecoder& OutDecoder) const;
+
+private:
+	template <typename T>
+	static void DecodeValue(FArchive& Archive, FDeprecationProperty::Variant& Variant)
+	{
+		T Value;
+		Archive << Value;
+		StoreValue(Variant, Value, TIntegralConstant<bool, TDeprecationVariantTraits<T>::Type != EDeprecationVariantType::None>());
+	}
+
+	template <typename T>
+	static inline void StoreValue(FDeprecationProperty::Variant& Variant, const T& Value, TIntegralConstant<bool, true>)
+	{
+		Variant.Set(Value);
+	}
+
+	template <typename T>
+	static inline void StoreValue(FDeprecationProperty::Variant& Variant, const T& Value, TIntegralConstant<bool, false>)
+	{
+		Variant.SetStruct(Value);
+	}
+
+
+
+
+	// Fields
+private:
+	mutable FRWLock Lock;
+	TMap<FName, FDecoder> Decoders;
+};
+
+/**
+ * Decodes a project structure serialized natively straight into a variant, in a source file:
+ *
+ * DEPRECATION_BINARY_STRUCT(FMyPackedColor, 8);
+ *
+ * Values are read with Variant::GetStruct<FMyPackedColor>().
+ * @param StructType C++ type of the structure, default constructible, copyable and serialized with its FArchive operator<<.
+ * @param SerializedSize Size in bytes of a serialized value.
+ */
+#define DEPRECATION_BINARY_STRUCT(StructType, SerializedSize) \
+	static const FDeprecationStructDecoders::TRegistrar<StructType> DeprecationStructDecoderRegistrar_##StructType( \
+		TEXT(#StructType) + 1, SerializedSize)
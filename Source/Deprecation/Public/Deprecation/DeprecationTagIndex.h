@@ -0,0 +1,188 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Deprecation/DeprecationPropertyTag.h"
+
+/**
+ * Compact index of the property tags found in an asset file.
+ * Only tag headers are decoded, values stay in the file until they are requested.
+ */
+class DEPRECATION_API FDeprecationTagIndex final
+{
+	// Typedefs
+public:
+	/**
+	 * Location and type of a single property value in the file.
+	 */
+	struct FEntry
+	{
+		FName Name;
+		FName Type;
+		FName StructName;
+		FName InnerType;
+		FName ValueType;
+
+		/** INDEX_NONE for unversioned properties, which are never decoded. */
+		int64 ValueOffset;
+		int32 Size;
+		int32 ArrayIndex;
+		uint8 BoolVal;
+
+		/**
+		 * Rebuilds a property tag from the entry so the value can be decoded.
+		 * @returns Tag holding the type information of the entry.
+		 */
+		inline FDeprecationPropertyTag MakeTag() const
+		{
+			FDeprecationPropertyTag Tag;
+			Tag.Name = Name;
+			Tag.Type = Type;
+			Tag.StructName = StructName;
+			Tag.InnerType = InnerType;
+			Tag.ValueType = ValueType;
+			Tag.Size = Size;
+			Tag.ArrayIndex = ArrayIndex;
+			Tag.BoolVal = BoolVal;
+
+			return Tag;
+		}
+	};
+
+
+
+
+	// Methods
+public:
+	/**
+	 * Adds an entry for the given tag.
+	 * If a tag with the same name already exists (static arrays), lookups keep returning the first one,
+	 * which is also the one the tree of the object is generated from.
+	 * @param Tag Tag read from the file.
+	 * @param ValueOffset Position of the value in the file, right after the tag.
+	 * @returns Newly created entry.
+	 */
+	inline const FEntry& Add(const FDeprecationPropertyTag& Tag, int64 ValueOffset)
+	{
+		const int32 EntryIndex = Entries.Num();
+		FEntry& Entry = Entries.AddDefaulted_GetRef();
+
+		Entry.Name = Tag.Name;
+		Entry.Type = Tag.Type;
+		Entry.StructName = Tag.StructName;
+		Entry.InnerType = Tag.InnerType;
+		Entry.ValueType = Tag.ValueType;
+		Entry.ValueOffset = ValueOffset;
+		Entry.Size = Tag.Size;
+		Entry.ArrayIndex = Tag.ArrayIndex;
+		Entry.BoolVal = Tag.BoolVal;
+
+		if (!EntryIndices.Contains(Tag.Name))
+		{
+			EntryIndices.Add(Tag.Name, EntryIndex);
+		}
+		return Entry;
+	}
+
+	/**
+	 * Looks for the entry of a property.
+	 * For static arrays, this is the entry of the first element saved.
+	 * @param PropertyName Name of the property to look for.
+	 * @returns The entry if found, nullptr otherwise.
+	 */
+	inline const FEntry* Find(FName PropertyName) const
+	{
+		const int32* EntryIndex = EntryIndices.Find(PropertyName);
+		return EntryIndex ? &Entries[*EntryIndex] : nullptr;
+	}
+
+	/**
+	 * Removes all the entries.
+	 */
+	inline void Reset()
+	{
+		Entries.Reset();
+		EntryIndices.Reset();
+		ResumeOffset = INDEX_NONE;
+		bIsComplete = false;
+	}
+
+	/**
+	 * Marks the index as partially built, so it can be completed later.
+	 * @param Offset Position in the file of the next tag to read.
+	 */
+	inline void Suspend(int64 Offset)
+	{
+		ResumeOffset = Offset;
+	}
+
+	/**
+	 * Marks the index as complete, all the tags of the file have been read.
+	 */
+	inline void Complete()
+	{
+		ResumeOffset = INDEX_NONE;
+		bIsComplete = true;
+	}
+
+
+
+
+	// Properties
+public:
+	/**
+	 * Returns all the entries, in file order.
+	 */
+	inline const TArray<FEntry>& GetEntries() const
+	{
+		return Entries;
+	}
+
+	/**
+	 * Returns the number of entries.
+	 */
+	inline int32 Num() const
+	{
+		return Entries.Num();
+	}
+
+	/**
+	 * Returns the serialized size of the values of all the entries.
+	 */
+	inline int64 GetSerializedSize() const
+	{
+		int64 SerializedSize = 0;
+		for (const FEntry& Entry : Entries)
+		{
+			SerializedSize += Entry.Size;
+		}
+		return SerializedSize;
+	}
+
+	/**
+	 * Returns the position in the file of the next tag to read, if the index was suspended.
+	 */
+	inline int64 GetResumeOffset() const
+	{
+		return ResumeOffset;
+	}
+
+	/**
+	 * Returns whether or not all the tags of the file have been read.
+	 */
+	inline bool IsComplete() const
+	{
+		return bIsComplete;
+	}
+
+
+
+
+	// Fields
+private:
+	TArray<FEntry> Entries;
+	TMap<FName, int32> EntryIndices;
+
+	int64 ResumeOffset = INDEX_NONE;
+	bool bIsComplete = false;
+};
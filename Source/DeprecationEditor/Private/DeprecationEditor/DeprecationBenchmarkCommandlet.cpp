@@ -0,0 +1,297 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "DeprecationEditor/DeprecationBenchmarkCommandlet.h"
+
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectHash.h"
+
+#include "Deprecation/DeprecationArena.h"
+#include "Deprecation/DeprecationScope.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDeprecationBenchmark, Log, All);
+
+//------------------------
+namespace
+{
+	/** Root of the generated packages, mapped to the saved directory of the project. */
+	const TCHAR* const BenchmarkPackageRoot = TEXT("/Temp/DeprecationBenchmark/");
+
+	/** Names of the cases, in the order of ECase. */
+	const TCHAR* const CaseNames[] = { TEXT("Flat"), TEXT("Nested"), TEXT("LargeArrays"), TEXT("Containers"), TEXT("References") };
+
+	/** Names of the modes, in the order of EDeprecationBenchmarkMode. */
+	const TCHAR* const ModeNames[] = { TEXT("WithoutScope"), TEXT("Current"), TEXT("Upgraded") };
+
+	constexpr int32 NumModes = UE_ARRAY_COUNT(ModeNames);
+
+	//------------------------
+	uint64 GetTotalHeapAllocations()
+	{
+		// Only counted by the allocators that implement it, zero otherwise.
+		return FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls;
+	}
+
+	//------------------------
+	FDeprecationBenchmarkLeaf MakeLeaf(int32 Index)
+	{
+		FDeprecationBenchmarkLeaf Leaf;
+		Leaf.IntValue = Index;
+		Leaf.VectorValue = FVector((float)Index);
+		Leaf.NameValue = FName(TEXT("Leaf"), Index % 16);
+		return Leaf;
+	}
+}
+
+//------------------------
+UDeprecationBenchmarkCommandlet::UDeprecationBenchmarkCommandlet()
+	: NumObjects(1000)
+	, NumIterations(5)
+	, ArraySize(256)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+//------------------------
+int32 UDeprecationBenchmarkCommandlet::Main(const FString& Params)
+{
+	FParse::Value(*Params, TEXT("Objects="), NumObjects);
+	FParse::Value(*Params, TEXT("Iterations="), NumIterations);
+	FParse::Value(*Params, TEXT("ArraySize="), ArraySize);
+
+	NumObjects = FMath::Max(NumObjects, 1);
+	NumIterations = FMath::Max(NumIterations, 1);
+	ArraySize = FMath::Max(ArraySize, 1);
+
+	FString CsvFilename;
+	FParse::Value(*Params, TEXT("Csv="), CsvFilename);
+
+	TArray<FString> CsvLines;
+	CsvLines.Add(TEXT("Case,Mode,MicrosecondsPerObject,ArenaBytesPerObject,ArenaAllocationsPerObject,HeapAllocationsPerObject,PeakBytesPerObject"));
+
+	UE_LOG(LogDeprecationBenchmark, Display, TEXT("%d objects per package, %d iterations, %d elements per array."), NumObjects, NumIterations, ArraySize);
+	UE_LOG(LogDeprecationBenchmark, Display, TEXT("%-12s %-12s %12s %12s %12s %12s %12s"), TEXT("Case"), TEXT("Mode"),
+		TEXT("us/object"), TEXT("bytes/object"), TEXT("allocs/object"), TEXT("heap/object"), TEXT("peak/object"));
+
+	int32 ExitCode = 0;
+
+	for (int32 CaseIndex = 0; CaseIndex < (int32)ECase::Count; ++CaseIndex)
+	{
+		for (int32 ModeIndex = 0; ModeIndex < NumModes; ++ModeIndex)
+		{
+			const ECase Case = (ECase)CaseIndex;
+			const EDeprecationBenchmarkMode Mode = (EDeprecationBenchmarkMode)ModeIndex;
+			const FString PackageName = FString(BenchmarkPackageRoot) + CaseNames[CaseIndex] + TEXT("_") + ModeNames[ModeIndex];
+
+			if (!SavePackage(PackageName, Case, Mode))
+			{
+				UE_LOG(LogDeprecationBenchmark, Error, TEXT("Unable to save package '%s'."), *PackageName);
+				ExitCode = 1;
+				continue;
+			}
+
+			const FResult Result = LoadPackage(PackageName, Mode);
+
+			UE_LOG(LogDeprecationBenchmark, Display, TEXT("%-12s %-12s %12.3f %12.1f %12.2f %12.2f %12.1f"),
+				CaseNames[CaseIndex], ModeNames[ModeIndex], Result.SecondsPerObject * 1000000.0, Result.BytesPerObject, Result.AllocationsPerObject,
+				Result.HeapAllocationsPerObject, Result.PeakBytesPerObject);
+
+			CsvLines.Add(FString::Printf(TEXT("%s,%s,%f,%f,%f,%f,%f"),
+				CaseNames[CaseIndex], ModeNames[ModeIndex], Result.SecondsPerObject * 1000000.0, Result.BytesPerObject, Result.AllocationsPerObject,
+				Result.HeapAllocationsPerObject, Result.PeakBytesPerObject));
+		}
+	}
+
+	if (!CsvFilename.IsEmpty() && !FFileHelper::SaveStringArrayToFile(CsvLines, *CsvFilename))
+	{
+		UE_LOG(LogDeprecationBenchmark, Error, TEXT("Unable to write results to '%s'."), *CsvFilename);
+		ExitCode = 1;
+	}
+
+	UDeprecationBenchmarkObject::Mode = EDeprecationBenchmarkMode::WithoutScope;
+	return ExitCode;
+}
+
+//------------------------
+bool UDeprecationBenchmarkCommandlet::SavePackage(const FString& PackageName, ECase Case, EDeprecationBenchmarkMode Mode) const
+{
+	UDeprecationBenchmarkObject::Mode = Mode;
+
+	UPackage* Package = CreatePackage(nullptr, *PackageName);
+	Package->SetPackageFlags(PKG_NewlyCreated);
+
+	TArray<UDeprecationBenchmarkObject*> Objects;
+	Objects.Reserve(NumObjects);
+
+	for (int32 Index = 0; Index < NumObjects; ++Index)
+	{
+		const FName ObjectName(TEXT("Object"), Index);
+		Objects.Add(NewObject<UDeprecationBenchmarkObject>(Package, ObjectName, RF_Public | RF_Standalone));
+	}
+
+	for (int32 Index = 0; Index < NumObjects; ++Index)
+	{
+		FillObject(Objects[Index], Case, Index, Objects);
+
+		// Saved with an older version, so every object is upgraded at load time.
+		if (Mode == EDeprecationBenchmarkMode::Upgraded)
+		{
+			Objects[Index]->DeprecationVersion = 0;
+		}
+	}
+
+	const FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+	const bool bIsSaved = UPackage::SavePackage(Package, nullptr, RF_Standalone, *Filename, GError, nullptr, false, true, SAVE_NoError);
+
+	UnloadPackage(Package);
+	return bIsSaved;
+}
+
+//------------------------
+void UDeprecationBenchmarkCommandlet::FillObject(UDeprecationBenchmarkObject* Object, ECase Case,
+	int32 Index, const TArray<UDeprecationBenchmarkObject*>& Objects) const
+{
+	// Every case has the flat properties, they are cheap next to the others.
+	Object->IntValue = Index;
+	Object->FloatValue = (float)Index;
+	Object->bBoolValue = (Index % 2) != 0;
+	Object->NameValue = FName(TEXT("Name"), Index % 16);
+	Object->StringValue = FString::Printf(TEXT("Benchmark object %d"), Index);
+	Object->VectorValue = FVector((float)Index);
+	Object->ColorValue = FLinearColor::White;
+
+	switch (Case)
+	{
+	case ECase::Nested:
+	{
+		const int32 NumBranches = FMath::Max(ArraySize / 16, 1);
+		Object->Trunks.SetNum(4);
+
+		for (FDeprecationBenchmarkTrunk& Trunk : Object->Trunks)
+		{
+			Trunk.StringValue = Object->StringValue;
+			Trunk.Branch.Leaf = MakeLeaf(Index);
+			Trunk.Branches.SetNum(NumBranches);
+
+			for (FDeprecationBenchmarkBranch& Branch : Trunk.Branches)
+			{
+				Branch.Leaf = MakeLeaf(Index);
+				Branch.Leaves.Add(MakeLeaf(Index));
+				Branch.Leaves.Add(MakeLeaf(Index + 1));
+			}
+		}
+		break;
+	}
+
+	case ECase::LargeArrays:
+		Object->IntArray.Reserve(ArraySize);
+		Object->FloatArray.Reserve(ArraySize);
+		Object->VectorArray.Reserve(ArraySize);
+
+		for (int32 ElementIndex = 0; ElementIndex < ArraySize; ++ElementIndex)
+		{
+			Object->IntArray.Add(ElementIndex);
+			Object->FloatArray.Add((float)ElementIndex);
+			Object->VectorArray.Add(FVector((float)ElementIndex));
+		}
+		break;
+
+	case ECase::Containers:
+		for (int32 ElementIndex = 0; ElementIndex < ArraySize; ++ElementIndex)
+		{
+			Object->NameToIntMap.Add(FName(TEXT("Key"), ElementIndex), ElementIndex);
+			Object->IntToLeafMap.Add(ElementIndex, MakeLeaf(ElementIndex));
+			Object->IntSet.Add(ElementIndex);
+		}
+		break;
+
+	case ECase::References:
+		// Exports of the same package, and the class as an import.
+		for (int32 ElementIndex = 0; ElementIndex < FMath::Min(ArraySize, Objects.Num()); ++ElementIndex)
+		{
+			Object->References.Add(Objects[(Index + ElementIndex) % Objects.Num()]);
+		}
+		Object->References.Add(UDeprecationBenchmarkObject::StaticClass());
+		break;
+
+	default:
+		break;
+	}
+}
+
+//------------------------
+UDeprecationBenchmarkCommandlet::FResult UDeprecationBenchmarkCommandlet::LoadPackage(const FString& PackageName, EDeprecationBenchmarkMode Mode) const
+{
+	UDeprecationBenchmarkObject::Mode = Mode;
+
+	FResult BestResult;
+	BestResult.SecondsPerObject = MAX_dbl;
+	BestResult.BytesPerObject = 0.0;
+	BestResult.AllocationsPerObject = 0.0;
+	BestResult.HeapAllocationsPerObject = 0.0;
+	BestResult.PeakBytesPerObject = 0.0;
+
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		// Arenas are accounted once released, which is once every upgrade has run.
+		const uint64 ArenaSizeBefore = FDeprecationArena::GetTotalAllocatedSize();
+		const uint64 ArenaAllocationsBefore = FDeprecationArena::GetTotalNumAllocations();
+		const uint64 HeapAllocationsBefore = GetTotalHeapAllocations();
+		const FPlatformMemoryStats MemoryBefore = FPlatformMemory::GetStats();
+		const double StartTime = FPlatformTime::Seconds();
+
+		UPackage* Package = ::LoadPackage(nullptr, *PackageName, LOAD_None);
+		const FPlatformMemoryStats MemoryAfterLoad = FPlatformMemory::GetStats();
+		FDeprecationScope::FlushPendingUpgrades();
+
+		const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+		const uint64 HeapAllocationsAfter = GetTotalHeapAllocations();
+		const FPlatformMemoryStats MemoryAfter = FPlatformMemory::GetStats();
+
+		if (!Package)
+		{
+			UE_LOG(LogDeprecationBenchmark, Error, TEXT("Unable to load package '%s'."), *PackageName);
+			break;
+		}
+
+		BestResult.SecondsPerObject = FMath::Min(BestResult.SecondsPerObject, ElapsedTime / NumObjects);
+
+		// The same for every iteration, the loads decode the same data.
+		BestResult.BytesPerObject = (double)(FDeprecationArena::GetTotalAllocatedSize() - ArenaSizeBefore) / NumObjects;
+		BestResult.AllocationsPerObject = (double)(FDeprecationArena::GetTotalNumAllocations() - ArenaAllocationsBefore) / NumObjects;
+		BestResult.HeapAllocationsPerObject = (double)(HeapAllocationsAfter - HeapAllocationsBefore) / NumObjects;
+
+		// The peak of the process only tells about this load when it has been raised by it, otherwise
+		// the memory sampled after the load and after the upgrades is the best known peak.
+		uint64 PeakUsed = FMath::Max(MemoryAfterLoad.UsedPhysical, MemoryAfter.UsedPhysical);
+		if (MemoryAfter.PeakUsedPhysical > MemoryBefore.PeakUsedPhysical)
+		{
+			PeakUsed = FMath::Max(PeakUsed, MemoryAfter.PeakUsedPhysical);
+		}
+
+		const uint64 PeakGrowth = PeakUsed > MemoryBefore.UsedPhysical ? PeakUsed - MemoryBefore.UsedPhysical : 0;
+		BestResult.PeakBytesPerObject = FMath::Max(BestResult.PeakBytesPerObject, (double)PeakGrowth / NumObjects);
+
+		UnloadPackage(Package);
+	}
+
+	return BestResult;
+}
+
+//------------------------
+void UDeprecationBenchmarkCommandlet::UnloadPackage(UPackage* Package)
+{
+	ForEachObjectWithOuter(Package, [](UObject* Object)
+	{
+		Object->ClearFlags(RF_Standalone | RF_Public);
+	}, true);
+
+	ResetLoaders(Package);
+	CollectGarbage(RF_NoFlags);
+}
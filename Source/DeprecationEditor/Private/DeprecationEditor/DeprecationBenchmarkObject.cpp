@@ -0,0 +1,58 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "DeprecationEditor/DeprecationBenchmarkObject.h"
+
+#include "Deprecation/DeprecationScope.h"
+
+EDeprecationBenchmarkMode UDeprecationBenchmarkObject::Mode = EDeprecationBenchmarkMode::WithoutScope;
+int32 UDeprecationBenchmarkObject::NumVisitedValues = 0;
+
+//------------------------
+void UDeprecationBenchmarkObject::Serialize(FStructuredArchive::FRecord Record)
+{
+	const bool bIsLoading = Record.GetUnderlyingArchive().IsLoading();
+	const bool bUseScope = Mode == EDeprecationBenchmarkMode::Current
+		|| (Mode == EDeprecationBenchmarkMode::Upgraded && bIsLoading);
+
+	if (!bUseScope)
+	{
+		Super::Serialize(Record);
+		return;
+	}
+
+	DEPRECATION_SCOPE_LOCAL(&UDeprecationBenchmarkObject::HandleDeprecation);
+	Super::Serialize(Record);
+}
+
+//------------------------
+void UDeprecationBenchmarkObject::HandleDeprecation(const FDeprecationProperty::Map& PropertyMap, uint64 AssetVersion, uint64 CodeVersion)
+{
+	NumVisitedValues += VisitProperties(PropertyMap);
+}
+
+//------------------------
+int32 UDeprecationBenchmarkObject::VisitProperties(const FDeprecationProperty::Map& PropertyMap)
+{
+	int32 NumValues = 0;
+
+	for (const TPair<FName, FDeprecationProperty>& Pair : PropertyMap)
+	{
+		const FDeprecationProperty& Property = Pair.Value;
+		NumValues += Property.NumValues();
+
+		if (Property.IsPacked())
+		{
+			continue;
+		}
+
+		for (const FDeprecationProperty::Variant& Value : Property.GetValues())
+		{
+			if (Value.GetType() == EDeprecationVariantType::Properties)
+			{
+				NumValues += VisitProperties(*Value.GetProperties());
+			}
+		}
+	}
+
+	return NumValues;
+}
@@ -0,0 +1,5 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "DeprecationEditor/DeprecationEditorModule.h"
+
+IMPLEMENT_MODULE(FDeprecationEditorModule, DeprecationEditor)
@@ -0,0 +1,489 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "DeprecationEditor/DeprecationResaveCommandlet.h"
+
+#include "AssetRegistryModule.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "UObject/LinkerLoad.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectIterator.h"
+#include "UObject/UnrealType.h"
+
+#include "Deprecation/DeprecationScope.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDeprecationResave, Log, All);
+
+//------------------------
+namespace
+{
+	/** Number of packages processed between two garbage collections. */
+	constexpr int32 GarbageCollectionInterval = 50;
+
+	/** Number of seconds between two progress reports. */
+	constexpr double ReportInterval = 5.0;
+
+	/** Names of the package results in progress files, in the order of EPackageResult. */
+	const TCHAR* const ResultNames[] = { TEXT("Upgraded"), TEXT("Current"), TEXT("Failed") };
+
+	//------------------------
+	void ReportProgress(int32 NumProcessed, int32 NumPackages, double StartTime)
+	{
+		const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+		const double Throughput = ElapsedTime > 0.0 ? NumProcessed / ElapsedTime : 0.0;
+
+		UE_LOG(LogDeprecationResave, Display, TEXT("Processed %d/%d packages in %.1fs (%.2f assets/s)."),
+			NumProcessed, NumPackages, ElapsedTime, Throughput);
+	}
+}
+
+//------------------------
+UDeprecationResaveCommandlet::UDeprecationResaveCommandlet()
+	: bAllPackages(false)
+	, bResume(false)
+	, NumWorkers(1)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+//------------------------
+int32 UDeprecationResaveCommandlet::Main(const FString& Params)
+{
+	FString VersionPropertyString(TEXT("DeprecationVersion"));
+	FParse::Value(*Params, TEXT("VersionProperty="), VersionPropertyString);
+	VersionPropertyName = FName(*VersionPropertyString);
+
+	ProgressDir = FPaths::ProjectSavedDir() / TEXT("Deprecation") / TEXT("Resave");
+	FParse::Value(*Params, TEXT("ProgressDir="), ProgressDir);
+
+	FString PathsString(TEXT("/Game"));
+	FParse::Value(*Params, TEXT("Paths="), PathsString);
+	PathsString.ParseIntoArray(Paths, TEXT("+"));
+
+	bAllPackages = FParse::Param(*Params, TEXT("AllPackages"));
+	bResume = FParse::Param(*Params, TEXT("Resume"));
+
+	NumWorkers = FMath::Max(FPlatformMisc::NumberOfCores() - 1, 1);
+	FParse::Value(*Params, TEXT("Workers="), NumWorkers);
+
+	FindDeprecationClasses();
+
+	// Worker process, processing its shard of the list written by the main process.
+	FString PackageListFilename;
+	if (FParse::Value(*Params, TEXT("PackageList="), PackageListFilename))
+	{
+		int32 Shard = 0;
+		int32 NumShards = 1;
+		FParse::Value(*Params, TEXT("Shard="), Shard);
+		FParse::Value(*Params, TEXT("NumShards="), NumShards);
+
+		TArray<FString> PackageNameStrings;
+		if (!FFileHelper::LoadFileToStringArray(PackageNameStrings, *PackageListFilename))
+		{
+			UE_LOG(LogDeprecationResave, Error, TEXT("Unable to read package list '%s'."), *PackageListFilename);
+			return 1;
+		}
+
+		TArray<FName> PackageNames;
+		PackageNames.Reserve(PackageNameStrings.Num());
+		for (const FString& PackageNameString : PackageNameStrings)
+		{
+			PackageNames.Add(FName(*PackageNameString));
+		}
+
+		return RunShard(PackageNames, Shard, NumShards);
+	}
+
+	if (DeprecationClasses.Num() == 0)
+	{
+		UE_LOG(LogDeprecationResave, Display, TEXT("No class declares a '%s' property, nothing to do."), *VersionPropertyName.ToString());
+		return 0;
+	}
+
+	TArray<FName> PackageNames;
+	FindPackages(PackageNames);
+
+	if (bResume)
+	{
+		TSet<FName> ProcessedPackageNames;
+		ReadProgress(ProcessedPackageNames);
+
+		const int32 NumPackages = PackageNames.Num();
+		PackageNames.RemoveAll([&ProcessedPackageNames](FName PackageName) { return ProcessedPackageNames.Contains(PackageName); });
+
+		UE_LOG(LogDeprecationResave, Display, TEXT("Resuming, %d/%d packages already processed."), NumPackages - PackageNames.Num(), NumPackages);
+	}
+	else
+	{
+		IFileManager::Get().DeleteDirectory(*ProgressDir, false, true);
+	}
+
+	UE_LOG(LogDeprecationResave, Display, TEXT("%d packages to process with %d class(es) declaring '%s'."),
+		PackageNames.Num(), DeprecationClasses.Num(), *VersionPropertyName.ToString());
+
+	if (PackageNames.Num() == 0)
+	{
+		return 0;
+	}
+
+	return RunWorkers(PackageNames);
+}
+
+//------------------------
+void UDeprecationResaveCommandlet::FindDeprecationClasses()
+{
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		if (Class->HasAnyClassFlags(CLASS_Deprecated | CLASS_NewerVersionExists))
+		{
+			continue;
+		}
+
+		if (!CastField<FUInt64Property>(Class->FindPropertyByName(VersionPropertyName)))
+		{
+			continue;
+		}
+
+		DeprecationClasses.Add(Class);
+	}
+}
+
+//------------------------
+void UDeprecationResaveCommandlet::FindPackages(TArray<FName>& OutPackageNames) const
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.bRecursivePaths = true;
+	for (const FString& Path : Paths)
+	{
+		Filter.PackagePaths.Add(FName(*Path));
+	}
+
+	if (!bAllPackages)
+	{
+		Filter.bRecursiveClasses = true;
+		for (const UClass* Class : DeprecationClasses)
+		{
+			Filter.ClassNames.Add(Class->GetFName());
+		}
+	}
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	TSet<FName> PackageNames;
+	for (const FAssetData& Asset : Assets)
+	{
+		PackageNames.Add(Asset.PackageName);
+	}
+
+	// Sorted so every process agrees on the shards.
+	OutPackageNames = PackageNames.Array();
+	OutPackageNames.Sort(FNameLexicalLess());
+}
+
+//------------------------
+int32 UDeprecationResaveCommandlet::RunWorkers(const TArray<FName>& PackageNames)
+{
+	const int32 NumShards = FMath::Clamp(NumWorkers, 1, PackageNames.Num());
+	if (NumShards == 1)
+	{
+		return RunShard(PackageNames, 0, 1);
+	}
+
+	const FString PackageListFilename = FPaths::ConvertRelativePathToFull(ProgressDir / TEXT("PackageList.txt"));
+
+	TArray<FString> PackageNameStrings;
+	PackageNameStrings.Reserve(PackageNames.Num());
+	for (FName PackageName : PackageNames)
+	{
+		PackageNameStrings.Add(PackageName.ToString());
+	}
+
+	if (!FFileHelper::SaveStringArrayToFile(PackageNameStrings, *PackageListFilename))
+	{
+		UE_LOG(LogDeprecationResave, Error, TEXT("Unable to write package list '%s'."), *PackageListFilename);
+		return 1;
+	}
+
+	const FString ProjectFilename = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+	const FString FullProgressDir = FPaths::ConvertRelativePathToFull(ProgressDir);
+
+	TArray<FProcHandle> Workers;
+	for (int32 Shard = 0; Shard < NumShards; ++Shard)
+	{
+		const FString WorkerParams = FString::Printf(
+			TEXT("\"%s\" -run=DeprecationResave -PackageList=\"%s\" -Shard=%d -NumShards=%d -VersionProperty=\"%s\" -ProgressDir=\"%s\" -unattended -nopause -nullrhi"),
+			*ProjectFilename, *PackageListFilename, Shard, NumShards, *VersionPropertyName.ToString(), *FullProgressDir);
+
+		FProcHandle Worker = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *WorkerParams, false, true, true, nullptr, 0, nullptr, nullptr);
+		if (!Worker.IsValid())
+		{
+			UE_LOG(LogDeprecationResave, Error, TEXT("Unable to start worker %d."), Shard);
+			continue;
+		}
+
+		Workers.Add(Worker);
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	double LastReportTime = StartTime;
+
+	// Initial progress, when resuming.
+	TSet<FName> ProcessedPackageNames;
+	ReadProgress(ProcessedPackageNames);
+	const int32 NumPreviouslyProcessed = ProcessedPackageNames.Num();
+
+	bool bIsRunning = true;
+	while (bIsRunning)
+	{
+		FPlatformProcess::Sleep(0.5f);
+
+		bIsRunning = false;
+		for (FProcHandle& Worker : Workers)
+		{
+			bIsRunning |= FPlatformProcess::IsProcRunning(Worker);
+		}
+
+		if (FPlatformTime::Seconds() - LastReportTime >= ReportInterval || !bIsRunning)
+		{
+			ProcessedPackageNames.Reset();
+			ReadProgress(ProcessedPackageNames);
+
+			ReportProgress(ProcessedPackageNames.Num() - NumPreviouslyProcessed, PackageNames.Num(), StartTime);
+			LastReportTime = FPlatformTime::Seconds();
+		}
+	}
+
+	int32 ExitCode = Workers.Num() == NumShards ? 0 : 1;
+	for (FProcHandle& Worker : Workers)
+	{
+		int32 WorkerExitCode = 0;
+		if (!FPlatformProcess::GetProcReturnCode(Worker, &WorkerExitCode) || WorkerExitCode != 0)
+		{
+			ExitCode = 1;
+		}
+
+		FPlatformProcess::CloseProc(Worker);
+	}
+
+	if (ExitCode != 0)
+	{
+		UE_LOG(LogDeprecationResave, Error, TEXT("Some workers failed, run again with -Resume to process the remaining packages."));
+	}
+
+	return ExitCode;
+}
+
+//------------------------
+int32 UDeprecationResaveCommandlet::RunShard(const TArray<FName>& PackageNames, int32 Shard, int32 NumShards)
+{
+	check(NumShards > 0);
+
+	TUniquePtr<FArchive> ProgressWriter(IFileManager::Get().CreateFileWriter(*GetProgressFilename(Shard), FILEWRITE_Append | FILEWRITE_AllowRead));
+	if (!ProgressWriter)
+	{
+		UE_LOG(LogDeprecationResave, Error, TEXT("Unable to open progress file '%s'."), *GetProgressFilename(Shard));
+		return 1;
+	}
+
+	// Objects may be upgraded while loading dependencies, their package is saved when its turn comes (if still loaded).
+	const FDelegateHandle UpgradedHandle = FDeprecationScope::OnObjectUpgraded().AddLambda([this](UObject* Object, uint64, uint64)
+	{
+		UpgradedPackages.Add(Object->GetOutermost()->GetFName());
+	});
+
+	const int32 NumPackages = (PackageNames.Num() - Shard + NumShards - 1) / NumShards;
+	const double StartTime = FPlatformTime::Seconds();
+	double LastReportTime = StartTime;
+
+	int32 NumProcessed = 0;
+	int32 NumResults[3] = { 0, 0, 0 };
+
+	for (int32 Index = Shard; Index < PackageNames.Num(); Index += NumShards)
+	{
+		const EPackageResult Result = ProcessPackage(PackageNames[Index]);
+		++NumResults[(int32)Result];
+		++NumProcessed;
+
+		// Recorded right away, so an interrupted run resumes from here.
+		const FString Line = FString::Printf(TEXT("%s\t%s\n"), *PackageNames[Index].ToString(), ResultNames[(int32)Result]);
+		FTCHARToUTF8 LineUtf8(*Line);
+		ProgressWriter->Serialize((void*)LineUtf8.Get(), LineUtf8.Length());
+		ProgressWriter->Flush();
+
+		if (NumProcessed % GarbageCollectionInterval == 0)
+		{
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+
+		if (FPlatformTime::Seconds() - LastReportTime >= ReportInterval)
+		{
+			ReportProgress(NumProcessed, NumPackages, StartTime);
+			LastReportTime = FPlatformTime::Seconds();
+		}
+	}
+
+	FDeprecationScope::OnObjectUpgraded().Remove(UpgradedHandle);
+
+	ReportProgress(NumProcessed, NumPackages, StartTime);
+	UE_LOG(LogDeprecationResave, Display, TEXT("%d upgraded, %d current, %d failed."),
+		NumResults[(int32)EPackageResult::Upgraded], NumResults[(int32)EPackageResult::Current], NumResults[(int32)EPackageResult::Failed]);
+
+	return NumResults[(int32)EPackageResult::Failed] == 0 ? 0 : 1;
+}
+
+//------------------------
+UDeprecationResaveCommandlet::EPackageResult UDeprecationResaveCommandlet::ProcessPackage(FName PackageName)
+{
+	const FString PackageNameString = PackageName.ToString();
+
+	FString Filename;
+	if (!FPackageName::DoesPackageExist(PackageNameString, nullptr, &Filename))
+	{
+		UE_LOG(LogDeprecationResave, Warning, TEXT("Package '%s' not found."), *PackageNameString);
+		return EPackageResult::Failed;
+	}
+
+	if (!UpgradedPackages.Contains(PackageName) && IsPackageCurrent(PackageName, Filename))
+	{
+		return EPackageResult::Current;
+	}
+
+	UPackage* Package = LoadPackage(nullptr, *Filename, LOAD_None);
+	if (!Package)
+	{
+		UE_LOG(LogDeprecationResave, Warning, TEXT("Unable to load package '%s'."), *PackageNameString);
+		return EPackageResult::Failed;
+	}
+
+	// Upgrades deferred by async loading, the core ticker does not tick in commandlets.
+	FDeprecationScope::FlushPendingUpgrades();
+
+	if (!UpgradedPackages.Contains(PackageName))
+	{
+		return EPackageResult::Current;
+	}
+
+	if (IFileManager::Get().IsReadOnly(*Filename))
+	{
+		UE_LOG(LogDeprecationResave, Warning, TEXT("Package '%s' is read only, check it out before resaving."), *PackageNameString);
+		return EPackageResult::Failed;
+	}
+
+	// Maps are saved through their world, other packages through their standalone objects.
+	UWorld* World = UWorld::FindWorldInPackage(Package);
+	const bool bIsSaved = UPackage::SavePackage(Package, World, World ? RF_NoFlags : RF_Standalone, *Filename,
+		GError, nullptr, false, true, SAVE_NoError);
+
+	if (!bIsSaved)
+	{
+		UE_LOG(LogDeprecationResave, Warning, TEXT("Unable to save package '%s'."), *PackageNameString);
+		return EPackageResult::Failed;
+	}
+
+	UpgradedPackages.Remove(PackageName);
+	return EPackageResult::Upgraded;
+}
+
+//------------------------
+bool UDeprecationResaveCommandlet::IsPackageCurrent(FName PackageName, const FString& Filename) const
+{
+	// Only the summary and the tables of the package are read, its objects are not loaded.
+	UPackage* Package = CreatePackage(nullptr, *PackageName.ToString());
+	FLinkerLoad* Linker = GetPackageLinker(Package, *Filename, LOAD_NoVerify | LOAD_Quiet, nullptr, nullptr);
+	if (!Linker)
+	{
+		return false;
+	}
+
+	// The package is not loaded, its linker must not keep the file open whatever the result.
+	ON_SCOPE_EXIT
+	{
+		ResetLoaders(Package);
+	};
+
+	const FCustomVersionContainer& PackageVersions = Linker->Summary.GetCustomVersionContainer();
+
+	for (const FObjectExport& Export : Linker->ExportMap)
+	{
+		// Classes exported by the package itself (e.g. blueprints) are only known once loaded.
+		if (Export.ClassIndex.IsExport())
+		{
+			return false;
+		}
+
+		if (Export.ClassIndex.IsNull())
+		{
+			continue;
+		}
+
+		UClass* Class = FindObject<UClass>(nullptr, *Linker->GetImportPathName(Export.ClassIndex));
+		if (!Class)
+		{
+			return false;
+		}
+
+		if (!CastField<FUInt64Property>(Class->FindPropertyByName(VersionPropertyName)))
+		{
+			continue;
+		}
+
+		// Every class has to be current: packages saved before custom versions were recorded, or before a class
+		// used a deprecation scope, have none for it.
+		FGuid Key;
+		int32 Version = 0;
+		if (!FDeprecationScope::GetClassCustomVersion(Class, VersionPropertyName, Key, Version))
+		{
+			return false;
+		}
+
+		const FCustomVersion* PackageVersion = PackageVersions.GetVersion(Key);
+		if (!PackageVersion || PackageVersion->Version < Version)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//------------------------
+void UDeprecationResaveCommandlet::ReadProgress(TSet<FName>& OutPackageNames) const
+{
+	TArray<FString> ProgressFilenames;
+	IFileManager::Get().FindFiles(ProgressFilenames, *(ProgressDir / TEXT("Progress_*.txt")), true, false);
+
+	for (const FString& ProgressFilename : ProgressFilenames)
+	{
+		TArray<FString> Lines;
+		FFileHelper::LoadFileToStringArray(Lines, *(ProgressDir / ProgressFilename));
+
+		for (const FString& Line : Lines)
+		{
+			FString PackageNameString;
+			FString ResultString;
+			// Failed packages are tried again.
+			if (Line.Split(TEXT("\t"), &PackageNameString, &ResultString) && ResultString != ResultNames[(int32)EPackageResult::Failed])
+			{
+				OutPackageNames.Add(FName(*PackageNameString));
+			}
+		}
+	}
+}
+
+//------------------------
+FString UDeprecationResaveCommandlet::GetProgressFilename(int32 Shard) const
+{
+	return ProgressDir / FString::Printf(TEXT("Progress_%d.txt"), Shard);
+}
@@ -0,0 +1,111 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "DeprecationEditor/DeprecationBenchmarkObject.h"
+
+#include "DeprecationBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures the load overhead of deprecation scopes and the cost of upgrades on synthetic packages.
+ * Every case (flat, nested, large arrays, containers, references) is saved and loaded in every mode
+ * (without scope, current, upgraded), and the wall time and memory per object are reported.
+ * Arena memory is the bytes and the number of allocations taken from the deprecation arenas by a load (see FDeprecationArena).
+ * Heap allocations are the calls to the global allocator during a load, and peak memory is the largest growth of the used
+ * physical memory of the process over the loads.
+ *
+ * Usage: -run=DeprecationBenchmark [-Objects=N] [-Iterations=N] [-ArraySize=N] [-Csv=File]
+ * -Objects Number of objects per package (1000 if none).
+ * -Iterations Number of loads measured per case, the best one is reported (5 if none).
+ * -ArraySize Number of elements of the arrays and containers (256 if none).
+ * -Csv File to write the results to.
+ */
+UCLASS()
+class DEPRECATIONEDITOR_API UDeprecationBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+	// Typedefs
+private:
+	enum class ECase : uint8
+	{
+		Flat,
+		Nested,
+		LargeArrays,
+		Containers,
+		References,
+
+		Count,
+	};
+
+	struct FResult
+	{
+		double SecondsPerObject;
+		double BytesPerObject;
+		double AllocationsPerObject;
+		double HeapAllocationsPerObject;
+		double PeakBytesPerObject;
+	};
+
+
+
+
+	// Constructors
+public:
+	UDeprecationBenchmarkCommandlet();
+
+
+
+
+	// UCommandlet
+public:
+	virtual int32 Main(const FString& Params) override;
+
+
+
+
+	// Methods
+private:
+	/**
+	 * Generates and saves the package of a case.
+	 * @param PackageName Name of the package to save.
+	 * @param Case Case to generate objects for.
+	 * @param Mode Mode the package is saved with.
+	 * @returns True if the package has been saved, false otherwise.
+	 */
+	bool SavePackage(const FString& PackageName, ECase Case, EDeprecationBenchmarkMode Mode) const;
+
+	/**
+	 * Fills the properties of an object for a case.
+	 * @param Object Object to fill.
+	 * @param Case Case to fill the object for.
+	 * @param Index Index of the object in its package.
+	 * @param Objects Objects of the package, already created.
+	 */
+	void FillObject(UDeprecationBenchmarkObject* Object, ECase Case, int32 Index, const TArray<UDeprecationBenchmarkObject*>& Objects) const;
+
+	/**
+	 * Loads the package of a case several times and measures the best load.
+	 * @param PackageName Name of the package to load.
+	 * @param Mode Mode the package is loaded with.
+	 * @returns Measures of the best load.
+	 */
+	FResult LoadPackage(const FString& PackageName, EDeprecationBenchmarkMode Mode) const;
+
+	/**
+	 * Unloads a package and collects its objects.
+	 */
+	static void UnloadPackage(UPackage* Package);
+
+
+
+
+	// Fields
+private:
+	int32 NumObjects;
+	int32 NumIterations;
+	int32 ArraySize;
+};
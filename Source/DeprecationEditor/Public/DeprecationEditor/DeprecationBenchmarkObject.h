@@ -0,0 +1,172 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+
+#include "Deprecation/DeprecationProperty.h"
+
+#include "DeprecationBenchmarkObject.generated.h"
+
+/**
+ * Innermost level of the nested structures of the benchmark.
+ */
+USTRUCT()
+struct FDeprecationBenchmarkLeaf
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 IntValue = 0;
+
+	UPROPERTY()
+	FVector VectorValue = FVector::ZeroVector;
+
+	UPROPERTY()
+	FName NameValue;
+};
+
+/**
+ * Intermediate level of the nested structures of the benchmark.
+ */
+USTRUCT()
+struct FDeprecationBenchmarkBranch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FDeprecationBenchmarkLeaf Leaf;
+
+	UPROPERTY()
+	TArray<FDeprecationBenchmarkLeaf> Leaves;
+
+	UPROPERTY()
+	float FloatValue = 0.0f;
+};
+
+/**
+ * Outermost level of the nested structures of the benchmark.
+ */
+USTRUCT()
+struct FDeprecationBenchmarkTrunk
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FDeprecationBenchmarkBranch Branch;
+
+	UPROPERTY()
+	TArray<FDeprecationBenchmarkBranch> Branches;
+
+	UPROPERTY()
+	FString StringValue;
+};
+
+/**
+ * How benchmark objects are saved and loaded.
+ */
+enum class EDeprecationBenchmarkMode : uint8
+{
+	/** Saved and loaded without deprecation scope. */
+	WithoutScope,
+
+	/** Saved and loaded with a deprecation scope, assets are current. */
+	Current,
+
+	/** Saved without deprecation scope and an older version, loaded with a deprecation scope: every object is upgraded. */
+	Upgraded,
+};
+
+/**
+ * Object generated by the benchmark commandlet, its properties are filled depending on the measured case.
+ */
+UCLASS()
+class DEPRECATIONEDITOR_API UDeprecationBenchmarkObject : public UObject
+{
+	GENERATED_BODY()
+
+	// UObject
+public:
+	virtual void Serialize(FStructuredArchive::FRecord Record) override;
+
+
+
+
+	// Methods
+private:
+	/**
+	 * Reads every property of the old structure, as an upgrade would.
+	 */
+	void HandleDeprecation(const FDeprecationProperty::Map& PropertyMap, uint64 AssetVersion, uint64 CodeVersion);
+
+	/**
+	 * Reads every property of a map and its nested maps.
+	 * @returns Number of values read.
+	 */
+	static int32 VisitProperties(const FDeprecationProperty::Map& PropertyMap);
+
+
+
+
+	// Fields
+public:
+	/** Mode of the objects being saved or loaded. */
+	static EDeprecationBenchmarkMode Mode;
+
+	/** Number of values read by the deprecation handlers, so their work is not optimized out. */
+	static int32 NumVisitedValues;
+
+	UPROPERTY()
+	uint64 DeprecationVersion = 1;
+
+	// Flat
+	UPROPERTY()
+	int32 IntValue = 0;
+
+	UPROPERTY()
+	float FloatValue = 0.0f;
+
+	UPROPERTY()
+	bool bBoolValue = false;
+
+	UPROPERTY()
+	FName NameValue;
+
+	UPROPERTY()
+	FString StringValue;
+
+	UPROPERTY()
+	FVector VectorValue = FVector::ZeroVector;
+
+	UPROPERTY()
+	FLinearColor ColorValue = FLinearColor::Black;
+
+	// Deep nesting
+	UPROPERTY()
+	TArray<FDeprecationBenchmarkTrunk> Trunks;
+
+	// Large arrays
+	UPROPERTY()
+	TArray<int32> IntArray;
+
+	UPROPERTY()
+	TArray<float> FloatArray;
+
+	UPROPERTY()
+	TArray<FVector> VectorArray;
+
+	// Maps and sets
+	UPROPERTY()
+	TMap<FName, int32> NameToIntMap;
+
+	UPROPERTY()
+	TMap<int32, FDeprecationBenchmarkLeaf> IntToLeafMap;
+
+	UPROPERTY()
+	TSet<int32> IntSet;
+
+	// Object references
+	UPROPERTY()
+	TArray<UObject*> References;
+};
@@ -0,0 +1,11 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+//-------------------------------
+class DEPRECATIONEDITOR_API FDeprecationEditorModule : public IModuleInterface
+{
+};
@@ -0,0 +1,129 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "DeprecationResaveCommandlet.generated.h"
+
+/**
+ * Finds the packages holding objects with a deprecation version property, loads them so they are upgraded, and resaves the upgraded ones.
+ * Packages are split between worker processes. Every processed package is recorded in a progress file, so an interrupted run can be resumed.
+ * Packages whose summary already records the current version of the deprecation class of every object they hold are skipped,
+ * their objects are not loaded.
+ *
+ * Usage: -run=DeprecationResave [-VersionProperty=Name] [-Paths=/Game/A+/Game/B] [-AllPackages] [-Workers=N] [-Resume] [-ProgressDir=Dir]
+ * -VersionProperty Name of the version property to look for (DeprecationVersion if none).
+ * -Paths Content paths to look into (/Game if none).
+ * -AllPackages Processes every package of the paths, not only the assets of deprecation classes (e.g. for maps and blueprints).
+ * -Workers Number of worker processes (number of cores minus one if none).
+ * -Resume Skips the packages processed by the previous run.
+ * -ProgressDir Directory of the progress files (Saved/Deprecation/Resave if none).
+ */
+UCLASS()
+class DEPRECATIONEDITOR_API UDeprecationResaveCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+	// Typedefs
+private:
+	enum class EPackageResult : uint8
+	{
+		Upgraded,
+		Current,
+		Failed,
+	};
+
+
+
+
+	// Constructors
+public:
+	UDeprecationResaveCommandlet();
+
+
+
+
+	// UCommandlet
+public:
+	virtual int32 Main(const FString& Params) override;
+
+
+
+
+	// Methods
+private:
+	/**
+	 * Looks for the loaded classes declaring the version property.
+	 */
+	void FindDeprecationClasses();
+
+	/**
+	 * Looks for the packages to process in the asset registry.
+	 * @param OutPackageNames Sorted names of the packages to process.
+	 */
+	void FindPackages(TArray<FName>& OutPackageNames) const;
+
+	/**
+	 * Splits the packages between worker processes, and waits for them to complete.
+	 * @param PackageNames Names of the packages to process.
+	 * @returns Exit code of the commandlet.
+	 */
+	int32 RunWorkers(const TArray<FName>& PackageNames);
+
+	/**
+	 * Processes the packages of a shard in the current process.
+	 * @param PackageNames Names of the packages of all the shards.
+	 * @param Shard Index of the shard to process.
+	 * @param NumShards Number of shards the packages are split into.
+	 * @returns Exit code of the commandlet.
+	 */
+	int32 RunShard(const TArray<FName>& PackageNames, int32 Shard, int32 NumShards);
+
+	/**
+	 * Loads a package, and resaves it if any of its objects has been upgraded.
+	 * @param PackageName Name of the package to process.
+	 * @returns Result of the processing.
+	 */
+	EPackageResult ProcessPackage(FName PackageName);
+
+	/**
+	 * Checks, from its summary and tables only, if a package has been saved with the current version of the deprecation class
+	 * of every object it holds. Unknown classes (e.g. blueprints not loaded yet) make the package be loaded.
+	 * @param PackageName Name of the package.
+	 * @param Filename Filename of the package.
+	 * @returns True if the package is known to be current, false if it has to be loaded.
+	 */
+	bool IsPackageCurrent(FName PackageName, const FString& Filename) const;
+
+	/**
+	 * Reads the names of the packages recorded in all the progress files.
+	 * @param OutPackageNames Names of the processed packages.
+	 */
+	void ReadProgress(TSet<FName>& OutPackageNames) const;
+
+	/**
+	 * Returns the path of the progress file of a shard.
+	 */
+	FString GetProgressFilename(int32 Shard) const;
+
+
+
+
+	// Fields
+private:
+	FName VersionPropertyName;
+	FString ProgressDir;
+
+	TArray<FString> Paths;
+	bool bAllPackages;
+	bool bResume;
+	int32 NumWorkers;
+
+	UPROPERTY(Transient)
+	TArray<UClass*> DeprecationClasses;
+
+	/** Packages holding an object upgraded since they were last saved. */
+	TSet<FName> UpgradedPackages;
+};